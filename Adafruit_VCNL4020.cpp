@@ -42,6 +42,11 @@
 
 #include <Adafruit_VCNL4020.h>
 
+#include "Adafruit_VCNL4020_Calibration.h"
+
+/// Attributes bus traffic until the end of the enclosing block to op
+#define VCNL4020_STATS_SCOPE(op) VCNL4020_SENSOR_STATS_SCOPE(this, op)
+
 /*!
  * @brief  Constructs an Adafruit_VCNL4020 object.
  */
@@ -50,8 +55,8 @@ Adafruit_VCNL4020::Adafruit_VCNL4020() {
 }
 
 /*!
- * @brief  Initializes the VCNL4020 sensor and checks for a valid Product ID
- * Revision.
+ * @brief  Initializes the VCNL4020 sensor with the default configuration from
+ * getDefaultConfig() and checks for a valid Product ID Revision.
  * @param  theWire  The I2C interface to use, defaults to Wire.
  * @param  addr     The I2C address of the VCNL4020, defaults to
  * VCNL4020_I2C_ADDRESS.
@@ -59,15 +64,78 @@ Adafruit_VCNL4020::Adafruit_VCNL4020() {
  * correct, otherwise False.
  */
 bool Adafruit_VCNL4020::begin(TwoWire *theWire, uint8_t addr) {
+  vcnl4020_config config;
+  getDefaultConfig(&config);
+  return begin(&config, theWire, addr);
+}
+
+/*!
+ * @brief  Initializes the VCNL4020 sensor with a caller supplied configuration
+ * and checks for a valid Product ID Revision. Only registers that differ from
+ * the configuration are written.
+ * @param  config   The configuration to apply.
+ * @param  theWire  The I2C interface to use, defaults to Wire.
+ * @param  addr     The I2C address of the VCNL4020, defaults to
+ * VCNL4020_I2C_ADDRESS.
+ * @return True if initialization was successful and Product ID Revision is
+ * correct, otherwise False.
+ */
+bool Adafruit_VCNL4020::begin(const vcnl4020_config *config, TwoWire *theWire,
+                              uint8_t addr) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_BEGIN);
+
+  return init(config, theWire, addr, true);
+}
+
+/*!
+ * @brief  Initializes the VCNL4020 sensor for a warm start, e.g. after its
+ * power domain was cycled. Skips begin()'s address probe and its up to 50 ms
+ * of retry delays: the single burst read of registers #0 through #15 is the
+ * probe, and only registers that differ from the configuration are written.
+ * A chip that already holds the configuration costs just that one read.
+ * @param  config   The configuration to apply, or NULL for the
+ * getDefaultConfig() one.
+ * @param  theWire  The I2C interface to use, defaults to Wire.
+ * @param  addr     The I2C address of the VCNL4020, defaults to
+ * VCNL4020_I2C_ADDRESS.
+ * @return True if initialization was successful and Product ID Revision is
+ * correct, otherwise False.
+ */
+bool Adafruit_VCNL4020::fastBegin(const vcnl4020_config *config,
+                                  TwoWire *theWire, uint8_t addr) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_BEGIN);
+
+  vcnl4020_config defaults;
+  if (!config) {
+    getDefaultConfig(&defaults);
+    config = &defaults;
+  }
+  return init(config, theWire, addr, false);
+}
+
+/*!
+ * @brief  Shared part of begin() and fastBegin().
+ * @param  config   The configuration to apply.
+ * @param  theWire  The I2C interface to use.
+ * @param  addr     The I2C address of the VCNL4020.
+ * @param  probe    True to probe the address, retrying with delays, before
+ * reading the registers.
+ * @return True if initialization was successful and Product ID Revision is
+ * correct, otherwise False.
+ */
+bool Adafruit_VCNL4020::init(const vcnl4020_config *config, TwoWire *theWire,
+                             uint8_t addr, bool probe) {
   // Initialize the I2C interface
   if (_i2c)
     delete _i2c;
 
   _i2c = new Adafruit_I2CDevice(addr, theWire);
+  _shadowValid = false;
+  _knownValid = false;
 
-  // Try to initialize I2C
-  bool found = false;
-  for (uint8_t retries = 0; retries < 5; retries++) {
+  // Try to initialize I2C, without a probe the burst read below finds out
+  bool found = !probe && _i2c->begin(false);
+  for (uint8_t retries = 0; probe && retries < 5; retries++) {
     if (_i2c->begin()) {
       found = true;
       break;
@@ -77,91 +145,247 @@ bool Adafruit_VCNL4020::begin(TwoWire *theWire, uint8_t addr) {
   if (!found)
     return false;
 
+  // Pull the whole register map into the shadow cache in one burst
+  if (!syncRegisters())
+    return false;
+  memcpy(_known, _shadow, VCNL4020_REG_COUNT);
+  _knownValid = true;
+
   // Check the Product ID Revision
   uint8_t prodRev = getProdRevision();
   if (prodRev != 0x21) {
     return false;
   }
 
-  // To set up all the configuration, first disable everything
-  enable(false /* ALS Enable */, false /* Proximity Enable */,
-         false /* Self-Timed Enable */);
-  setOnDemand(false /* ALS on demand read */, false /* Prox on demand read */);
-  // set fastest rate so folks see stuff, can always config lower power later
-  setProxRate(PROX_RATE_250_PER_S);
-  setProxLEDmA(200);
-  setAmbientRate(AMBIENT_RATE_10_SPS);
-  setAmbientAveraging(AVG_1_SAMPLES);
-
-  // default IRQ on data ready
-  setInterruptConfig(
-      true /* Proximity Ready */, true /* ALS Ready */, false /* Threshold */,
-      false /* true = Threshold ALS, false = Threshold Proximity */,
-      INT_COUNT_1 /* how many values before the INT fires */
-  );
-
-  // default freq
-  setProxFrequency(PROX_FREQ_390_625_KHZ);
-
-  enable(true /* ALS Enable */, true /* Proximity Enable */,
-         true /* Self-Timed Enable */);
+  return applyConfig(config);
+}
+
+/*!
+ * @brief  Fills in the configuration begin() uses when none is given: fastest
+ * rates so folks see stuff, 200 mA LED, IRQ on data ready, and both sensors
+ * self-timed. Can always config lower power later.
+ * @param  config  The configuration to fill in.
+ */
+void Adafruit_VCNL4020::getDefaultConfig(vcnl4020_config *config) {
+  config->proxRate = PROX_RATE_250_PER_S;
+  config->proxLEDmA = 200;
+  config->ambientRate = AMBIENT_RATE_10_SPS;
+  config->ambientAveraging = AVG_1_SAMPLES;
+  config->continuousConversion = false;
+  config->autoOffsetComp = true; // power-on default
+  config->interruptControl = vcnl4020_int_prox_ready_field::put(true) |
+                             vcnl4020_int_als_ready_field::put(true) |
+                             vcnl4020_int_count_field::put(INT_COUNT_1);
+  config->lowThreshold = 0;
+  config->highThreshold = 0;
+  config->proxFrequency = PROX_FREQ_390_625_KHZ;
+  config->alsEnable = true;
+  config->proxEnable = true;
+  config->selfTimed = true;
+}
+
+/*!
+ * @brief  Reads the current configuration out of the shadow cache.
+ * @param  config  The configuration to fill in.
+ * @return True if the configuration is known, false if the cache was stale
+ * and the registers could not be read.
+ */
+bool Adafruit_VCNL4020::getConfig(vcnl4020_config *config) {
+  if (!refreshRegisters())
+    return false;
+
+  config->proxRate = getProxRate();
+  config->proxLEDmA = getProxLEDmA();
+  config->ambientRate = getAmbientRate();
+  config->ambientAveraging = getAmbientAveraging();
+  config->continuousConversion = readField<vcnl4020_cont_conv_field>();
+  config->autoOffsetComp = readField<vcnl4020_auto_offset_field>();
+  config->interruptControl = getInterruptControl();
+  config->lowThreshold = getLowThreshold();
+  config->highThreshold = getHighThreshold();
+  config->proxFrequency = getProxFrequency();
+  config->alsEnable = readField<vcnl4020_als_en_field>();
+  config->proxEnable = readField<vcnl4020_prox_en_field>();
+  config->selfTimed = readField<vcnl4020_selftimed_en_field>();
+  return true;
+}
+
+/*!
+ * @brief  Applies a whole configuration, writing only the registers that
+ * differ from the shadow cache, see writeDifferences().
+ * @param  config  The configuration to apply.
+ * @return True if every write succeeded, otherwise false.
+ */
+bool Adafruit_VCNL4020::applyConfig(const vcnl4020_config *config) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_APPLY_CONFIG);
+
+  if (!refreshRegisters())
+    return false;
+
+  // Build the wanted register image, keeping bits we don't own
+  uint8_t target[VCNL4020_REG_COUNT];
+  memcpy(target, _shadow, VCNL4020_REG_COUNT);
+
+  uint8_t *reg = &target[vcnl4020_prox_rate_field::index];
+  *reg = vcnl4020_prox_rate_field::set(*reg, config->proxRate);
+  reg = &target[vcnl4020_led_current_field::index];
+  *reg = vcnl4020_led_current_field::set(*reg, config->proxLEDmA / 10);
+  target[vcnl4020_ambient_rate_field::index] =
+      vcnl4020_cont_conv_field::put(config->continuousConversion) |
+      vcnl4020_ambient_rate_field::put(config->ambientRate) |
+      vcnl4020_auto_offset_field::put(config->autoOffsetComp) |
+      vcnl4020_averaging_field::put(config->ambientAveraging);
+  target[VCNL4020_REG_INT_CTRL - VCNL4020_REG_FIRST] =
+      config->interruptControl;
+  target[VCNL4020_REG_LOW_THRES_HIGH - VCNL4020_REG_FIRST] =
+      config->lowThreshold >> 8;
+  target[VCNL4020_REG_LOW_THRES_LOW - VCNL4020_REG_FIRST] =
+      config->lowThreshold & 0xFF;
+  target[VCNL4020_REG_HIGH_THRES_HIGH - VCNL4020_REG_FIRST] =
+      config->highThreshold >> 8;
+  target[VCNL4020_REG_HIGH_THRES_LOW - VCNL4020_REG_FIRST] =
+      config->highThreshold & 0xFF;
+  reg = &target[vcnl4020_prox_freq_field::index];
+  *reg = vcnl4020_prox_freq_field::set(*reg, config->proxFrequency);
+
+  target[vcnl4020_enables_field::index] =
+      vcnl4020_als_en_field::put(config->alsEnable) |
+      vcnl4020_prox_en_field::put(config->proxEnable) |
+      vcnl4020_selftimed_en_field::put(config->selfTimed);
+
+  return writeDifferences(target);
+}
+
+/*!
+ * @brief  Writes the parameter registers and enable bits of a register image
+ * that differ from the shadow cache. Neighbouring registers are written
+ * together in auto-incrementing bursts, and measurements are only paused if a
+ * measurement parameter actually has to change.
+ * @param  target  The wanted image of registers #0 through #15.
+ * @return True if every write succeeded, otherwise false.
+ */
+bool Adafruit_VCNL4020::writeDifferences(const uint8_t *target) {
+  bool changed = false;
+  for (uint8_t i = 0; i < VCNL4020_REG_COUNT; i++) {
+    if (needsPause(i) && target[i] != _shadow[i])
+      changed = true;
+  }
+
+  // Remember the whole image up front, so that if a write below fails
+  // recover() restores it rather than the temporary pause
+  memcpy(_known, target, VCNL4020_REG_COUNT);
+  _known[vcnl4020_enables_field::index] &= vcnl4020_enables_field::mask;
+  _knownValid = true;
+
+  // To change the measurement parameters, first disable everything. This
+  // write is not part of the wanted state, so it bypasses writeRegister()
+  if (changed && _shadow[0] != 0) {
+    uint8_t pause = 0;
+    if (!busWrite(VCNL4020_REG_COMMAND, &pause, 1)) {
+      _shadowValid = false;
+      return false;
+    }
+    _shadow[vcnl4020_enables_field::index] = 0;
+  }
 
+  uint8_t i = 0;
+  while (i < VCNL4020_REG_COUNT) {
+    if (!isConfigRegister(i) || target[i] == _shadow[i]) {
+      i++;
+      continue;
+    }
+    // Stretch the burst to the last changed register of this contiguous
+    // block, rewriting any unchanged ones in between
+    uint8_t last = i;
+    for (uint8_t j = i + 1; j < VCNL4020_REG_COUNT && isConfigRegister(j);
+         j++) {
+      if (target[j] != _shadow[j])
+        last = j;
+    }
+    if (!writeRegisters(VCNL4020_REG_FIRST + i, &target[i], last - i + 1))
+      return false;
+    i = last + 1;
+  }
+
+  if (target[0] != _shadow[0])
+    return writeRegister(VCNL4020_REG_COMMAND, target[0]);
   return true;
 }
 
 /*!
  * @brief  Checks if the Ambient Light Sensor data is ready.
- * @return True if ALS data is ready, otherwise false.
+ * @return True if ALS data is ready, false if not or the read failed.
  */
 bool Adafruit_VCNL4020::isAmbientReady() {
-  // Create an I2C Register object for COMMAND REGISTER #0
-  Adafruit_BusIO_Register command_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_COMMAND);
+  bool ready = false;
+  return isAmbientReady(&ready) && ready;
+}
 
-  // Create a bit accessor for bit #6 (als_data_rdy)
-  Adafruit_BusIO_RegisterBits als_data_rdy =
-      Adafruit_BusIO_RegisterBits(&command_reg, 1, 6); // 1 bit at position 6
+/*!
+ * @brief  Checks if the Ambient Light Sensor data is ready, telling a bus
+ * error apart from data that is not ready yet.
+ * @param  ready  Where to store the als_data_rdy bit, untouched if the read
+ * failed.
+ * @return True if the read succeeded, otherwise false.
+ */
+bool Adafruit_VCNL4020::isAmbientReady(bool *ready) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_DATA_READY);
 
-  // Read the bit and return its value
-  return als_data_rdy.read();
+  // Read COMMAND REGISTER #0 and return bit #6 (als_data_rdy)
+  uint8_t command;
+  if (!busRead(VCNL4020_REG_COMMAND, &command, 1))
+    return false;
+  *ready = vcnl4020_als_data_rdy_field::get(command);
+  return true;
 }
 
 /*!
  * @brief  Checks if the Proximity data is ready.
- * @return True if Proximity data is ready, otherwise false.
+ * @return True if Proximity data is ready, false if not or the read failed.
  */
 bool Adafruit_VCNL4020::isProxReady() {
-  // Create an I2C Register object for COMMAND REGISTER #0
-  Adafruit_BusIO_Register command_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_COMMAND);
+  bool ready = false;
+  return isProxReady(&ready) && ready;
+}
 
-  // Create a bit accessor for bit #5 (prox_data_rdy)
-  Adafruit_BusIO_RegisterBits prox_data_rdy =
-      Adafruit_BusIO_RegisterBits(&command_reg, 1, 5); // 1 bit at position 5
+/*!
+ * @brief  Checks if the Proximity data is ready, telling a bus error apart
+ * from data that is not ready yet.
+ * @param  ready  Where to store the prox_data_rdy bit, untouched if the read
+ * failed.
+ * @return True if the read succeeded, otherwise false.
+ */
+bool Adafruit_VCNL4020::isProxReady(bool *ready) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_DATA_READY);
 
-  // Read the bit and return its value
-  return prox_data_rdy.read();
+  // Read COMMAND REGISTER #0 and return bit #5 (prox_data_rdy)
+  uint8_t command;
+  if (!busRead(VCNL4020_REG_COMMAND, &command, 1))
+    return false;
+  *ready = vcnl4020_prox_data_rdy_field::get(command);
+  return true;
 }
 
 /*!
  * @brief  Sets the on-demand bits for ALS and Proximity measurements.
  * @param  als  True to set the ALS on-demand bit, otherwise false.
  * @param  prox True to set the Proximity on-demand bit, otherwise false.
+ * @return True if the write was acknowledged, otherwise false.
  */
-void Adafruit_VCNL4020::setOnDemand(bool als, bool prox) {
-  // Create an I2C Register object for COMMAND REGISTER #0
-  Adafruit_BusIO_Register command_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_COMMAND);
+bool Adafruit_VCNL4020::setOnDemand(bool als, bool prox) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_ON_DEMAND);
 
-  // Create bit accessors for bit #4 (als_od) and bit #3 (prox_od)
-  Adafruit_BusIO_RegisterBits als_od =
-      Adafruit_BusIO_RegisterBits(&command_reg, 1, 4); // 1 bit at position 4
-  Adafruit_BusIO_RegisterBits prox_od =
-      Adafruit_BusIO_RegisterBits(&command_reg, 1, 3); // 1 bit at position 3
+  // The on-demand bits (#4 als_od, #3 prox_od) self-clear once the measurement
+  // is done, so they are never kept in the shadow copy of the command register
+  if (!refreshRegisters())
+    return false;
+  uint8_t command = cachedRegister(VCNL4020_REG_COMMAND) |
+                    vcnl4020_als_od_field::put(als) |
+                    vcnl4020_prox_od_field::put(prox);
 
-  // Set the bits based on the arguments
-  als_od.write(als);
-  prox_od.write(prox);
+  bool ok = writeRegister(VCNL4020_REG_COMMAND, command);
+  _shadow[vcnl4020_enables_field::index] &= vcnl4020_enables_field::mask;
+  return ok;
 }
 
 /*!
@@ -170,25 +394,17 @@ void Adafruit_VCNL4020::setOnDemand(bool als, bool prox) {
  * @param  prox       True to enable the Proximity, otherwise false.
  * @param  selftimed  True to enable the Self-Timed measurements, otherwise
  * false.
+ * @return True if the write was acknowledged, otherwise false.
  */
-void Adafruit_VCNL4020::enable(bool als, bool prox, bool selftimed) {
-  // Create an I2C Register object for COMMAND REGISTER #0
-  Adafruit_BusIO_Register command_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_COMMAND);
+bool Adafruit_VCNL4020::enable(bool als, bool prox, bool selftimed) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_ENABLE);
 
-  // Create bit accessors for bit #2 (als_en), bit #1 (prox_en), and bit #0
-  // (selftimed_en)
-  Adafruit_BusIO_RegisterBits als_en =
-      Adafruit_BusIO_RegisterBits(&command_reg, 1, 2); // 1 bit at position 2
-  Adafruit_BusIO_RegisterBits prox_en =
-      Adafruit_BusIO_RegisterBits(&command_reg, 1, 1); // 1 bit at position 1
-  Adafruit_BusIO_RegisterBits selftimed_en =
-      Adafruit_BusIO_RegisterBits(&command_reg, 1, 0); // 1 bit at position 0
+  // Bit #2 (als_en), bit #1 (prox_en), and bit #0 (selftimed_en)
+  uint8_t command = vcnl4020_als_en_field::put(als) |
+                    vcnl4020_prox_en_field::put(prox) |
+                    vcnl4020_selftimed_en_field::put(selftimed);
 
-  // Set the bits based on the arguments
-  als_en.write(als);
-  prox_en.write(prox);
-  selftimed_en.write(selftimed);
+  return writeRegister(VCNL4020_REG_COMMAND, command);
 }
 
 /*!
@@ -196,31 +412,19 @@ void Adafruit_VCNL4020::enable(bool als, bool prox, bool selftimed) {
  * @return 8-bit value representing the Product ID Revision.
  */
 uint8_t Adafruit_VCNL4020::getProdRevision() {
-  // Create an I2C Register object for Product ID Revision Register (Register
-  // #1)
-  Adafruit_BusIO_Register prod_id_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_PRODUCT_ID);
-
-  // Read the 8-bit value from the register and return it
-  return prod_id_reg.read();
+  // Read-only register, so the shadow copy is always valid
+  return cachedRegister(VCNL4020_REG_PRODUCT_ID);
 }
 
 /*!
  * @brief  Sets the Proximity Rate.
  * @param  rate  The rate to set, as defined in the vcnl4020_proxrate enum.
+ * @return True if the write was acknowledged, otherwise false.
  */
-void Adafruit_VCNL4020::setProxRate(vcnl4020_proxrate rate) {
-  // Create an I2C Register object for Register #2 (Rate of Proximity
-  // Measurement)
-  Adafruit_BusIO_Register prox_rate_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_PROX_RATE);
+bool Adafruit_VCNL4020::setProxRate(vcnl4020_proxrate rate) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_SET_PROX_CONFIG);
 
-  // Create a bit accessor for the 3-bit Proximity Rate field
-  Adafruit_BusIO_RegisterBits prox_rate_bits = Adafruit_BusIO_RegisterBits(
-      &prox_rate_reg, 3, 0); // 3 bits starting at position 0
-
-  // Write the 3-bit value to the register
-  prox_rate_bits.write(rate);
+  return writeField<vcnl4020_prox_rate_field>(rate);
 }
 
 /*!
@@ -228,35 +432,19 @@ void Adafruit_VCNL4020::setProxRate(vcnl4020_proxrate rate) {
  * @return The current rate, as defined in the vcnl4020_proxrate enum.
  */
 vcnl4020_proxrate Adafruit_VCNL4020::getProxRate() {
-  // Create an I2C Register object for Register #2 (Rate of Proximity
-  // Measurement)
-  Adafruit_BusIO_Register prox_rate_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_PROX_RATE);
-
-  // Create a bit accessor for the 3-bit Proximity Rate field
-  Adafruit_BusIO_RegisterBits prox_rate_bits = Adafruit_BusIO_RegisterBits(
-      &prox_rate_reg, 3, 0); // 3 bits starting at position 0
-
-  // Read the 3-bit value from the register
-  return (vcnl4020_proxrate)prox_rate_bits.read();
+  return (vcnl4020_proxrate)readField<vcnl4020_prox_rate_field>();
 }
 
 /*!
  * @brief  Sets the LED current for Proximity Mode in mA.
  * @param  LEDmA  The LED current in mA.
+ * @return True if the write was acknowledged, otherwise false.
  */
-void Adafruit_VCNL4020::setProxLEDmA(uint8_t LEDmA) {
-  // Create an I2C Register object for Register #3 (LED Current Setting for
-  // Proximity Mode)
-  Adafruit_BusIO_Register led_current_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_IR_LED_CURRENT);
+bool Adafruit_VCNL4020::setProxLEDmA(uint8_t LEDmA) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_SET_PROX_CONFIG);
 
-  // Create a bit accessor for the 6-bit LED current field
-  Adafruit_BusIO_RegisterBits led_current_bits = Adafruit_BusIO_RegisterBits(
-      &led_current_reg, 6, 0); // 6 bits starting at position 0
-
-  // Divide the LED current by 10 and write the value to the register
-  led_current_bits.write(LEDmA / 10);
+  // The LED current field of Register #3 is in units of 10 mA
+  return writeField<vcnl4020_led_current_field>(LEDmA / 10);
 }
 
 /*!
@@ -264,18 +452,7 @@ void Adafruit_VCNL4020::setProxLEDmA(uint8_t LEDmA) {
  * @return The LED current in mA.
  */
 uint8_t Adafruit_VCNL4020::getProxLEDmA() {
-  // Create an I2C Register object for Register #3 (LED Current Setting for
-  // Proximity Mode)
-  Adafruit_BusIO_Register led_current_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_IR_LED_CURRENT);
-
-  // Create a bit accessor for the 6-bit LED current field
-  Adafruit_BusIO_RegisterBits led_current_bits = Adafruit_BusIO_RegisterBits(
-      &led_current_reg, 6, 0); // 6 bits starting at position 0
-
-  // Read the value from the register and multiply by 10 to get the LED current
-  // in mA
-  return led_current_bits.read() * 10;
+  return readField<vcnl4020_led_current_field>() * 10;
 }
 
 /*!
@@ -285,19 +462,12 @@ uint8_t Adafruit_VCNL4020::getProxLEDmA() {
  * not use with self-timed mode. Please refer to the application information
  * chapter 3.3 for details about this function.
  * @param  enable  True to enable, False to disable.
+ * @return True if the write was acknowledged, otherwise false.
  */
-void Adafruit_VCNL4020::setContinuousConversion(bool enable) {
-  // Create an I2C Register object for Register #4 (Ambient Light Parameter)
-  Adafruit_BusIO_Register ambient_light_param_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_AMBIENT_PARAM);
+bool Adafruit_VCNL4020::setContinuousConversion(bool enable) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_SET_AMBIENT_CONFIG);
 
-  // Create a bit accessor for the Continuous Conversion mode bit (Bit 7)
-  Adafruit_BusIO_RegisterBits continuous_conversion_bit =
-      Adafruit_BusIO_RegisterBits(&ambient_light_param_reg, 1,
-                                  7); // 1 bit at position 7
-
-  // Write the value to the register
-  continuous_conversion_bit.write(enable ? 1 : 0);
+  return writeField<vcnl4020_cont_conv_field>(enable);
 }
 
 /*!
@@ -308,37 +478,23 @@ void Adafruit_VCNL4020::setContinuousConversion(bool enable) {
  * before each ambient light measurement and subtracted automatically from
  * actual reading.
  * @param  enable  True to enable, False to disable.
+ * @return True if the write was acknowledged, otherwise false.
  */
-void Adafruit_VCNL4020::setAutoOffsetComp(bool enable) {
-  // Create an I2C Register object for Register #4 (Ambient Light Parameter)
-  Adafruit_BusIO_Register ambient_light_param_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_AMBIENT_PARAM);
-
-  // Create a bit accessor for the Auto Offset Compensation bit (Bit 3)
-  Adafruit_BusIO_RegisterBits auto_offset_comp_bit =
-      Adafruit_BusIO_RegisterBits(&ambient_light_param_reg, 1,
-                                  3); // 1 bit at position 3
+bool Adafruit_VCNL4020::setAutoOffsetComp(bool enable) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_SET_AMBIENT_CONFIG);
 
-  // Write the value to the register
-  auto_offset_comp_bit.write(enable ? 1 : 0);
+  return writeField<vcnl4020_auto_offset_field>(enable);
 }
 
 /*!
  * @brief  Sets the Ambient Light Measurement Rate.
  * @param  rate  The rate to set, as defined in the vcnl4020_ambientrate enum.
+ * @return True if the write was acknowledged, otherwise false.
  */
-void Adafruit_VCNL4020::setAmbientRate(vcnl4020_ambientrate rate) {
-  // Create an I2C Register object for Register #4 (Ambient Light Parameter)
-  Adafruit_BusIO_Register ambient_light_param_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_AMBIENT_PARAM);
-
-  // Create a bit accessor for the 3-bit Ambient Light Measurement Rate field
-  // (Bits 6-4)
-  Adafruit_BusIO_RegisterBits ambient_rate_bits = Adafruit_BusIO_RegisterBits(
-      &ambient_light_param_reg, 3, 4); // 3 bits starting at position 4
+bool Adafruit_VCNL4020::setAmbientRate(vcnl4020_ambientrate rate) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_SET_AMBIENT_CONFIG);
 
-  // Write the 3-bit value to the register
-  ambient_rate_bits.write(rate);
+  return writeField<vcnl4020_ambient_rate_field>(rate);
 }
 
 /*!
@@ -346,35 +502,19 @@ void Adafruit_VCNL4020::setAmbientRate(vcnl4020_ambientrate rate) {
  * @return The current rate, as defined in the vcnl4020_ambientrate enum.
  */
 vcnl4020_ambientrate Adafruit_VCNL4020::getAmbientRate() {
-  // Create an I2C Register object for Register #4 (Ambient Light Parameter)
-  Adafruit_BusIO_Register ambient_light_param_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_AMBIENT_PARAM);
-
-  // Create a bit accessor for the 3-bit Ambient Light Measurement Rate field
-  // (Bits 6-4)
-  Adafruit_BusIO_RegisterBits ambient_rate_bits = Adafruit_BusIO_RegisterBits(
-      &ambient_light_param_reg, 3, 4); // 3 bits starting at position 3
-
-  // Read the 3-bit value from the register
-  return (vcnl4020_ambientrate)ambient_rate_bits.read();
+  return (vcnl4020_ambientrate)readField<vcnl4020_ambient_rate_field>();
 }
 
 /*!
  * @brief  Sets the Averaging function for Ambient Light Measurement.
  * @param  avg  The averaging setting to use, as defined in the
  * vcnl4020_averaging enum.
+ * @return True if the write was acknowledged, otherwise false.
  */
-void Adafruit_VCNL4020::setAmbientAveraging(vcnl4020_averaging avg) {
-  // Create an I2C Register object for Register #4 (Ambient Light Parameter)
-  Adafruit_BusIO_Register ambient_light_param_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_AMBIENT_PARAM);
-
-  // Create a bit accessor for the 3-bit Averaging function field (Bits 2-0)
-  Adafruit_BusIO_RegisterBits averaging_bits = Adafruit_BusIO_RegisterBits(
-      &ambient_light_param_reg, 3, 0); // 3 bits starting at position 0
+bool Adafruit_VCNL4020::setAmbientAveraging(vcnl4020_averaging avg) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_SET_AMBIENT_CONFIG);
 
-  // Write the 3-bit value to the register
-  averaging_bits.write(avg);
+  return writeField<vcnl4020_averaging_field>(avg);
 }
 
 /*!
@@ -385,57 +525,314 @@ void Adafruit_VCNL4020::setAmbientAveraging(vcnl4020_averaging avg) {
  * enum.
  */
 vcnl4020_averaging Adafruit_VCNL4020::getAmbientAveraging() {
-  // Create an I2C Register object for Register #4 (Ambient Light Parameter)
-  Adafruit_BusIO_Register ambient_light_param_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_AMBIENT_PARAM);
-
-  // Create a bit accessor for the 3-bit Averaging function field (Bits 2-0)
-  Adafruit_BusIO_RegisterBits averaging_bits = Adafruit_BusIO_RegisterBits(
-      &ambient_light_param_reg, 3, 0); // 3 bits starting at position 0
-
-  // Read the 3-bit value from the register
-  return (vcnl4020_averaging)averaging_bits.read();
+  return (vcnl4020_averaging)readField<vcnl4020_averaging_field>();
 }
 
 /*!
  * @brief  Reads the Ambient Light Sensor (ALS) measurement result.
- * @return The 16-bit ALS measurement result.
+ * @return The 16-bit ALS measurement result, 0xFFFF if the read failed.
  */
 uint16_t Adafruit_VCNL4020::readAmbient() {
-  // Create an I2C Register object for Register #5 and #6 (Ambient Light Result
-  // Register) The register is 2 bytes long and MSB-first
-  Adafruit_BusIO_Register als_result_reg = Adafruit_BusIO_Register(
-      _i2c, VCNL4020_REG_AMBIENT_RESULT_HIGH, 2, MSBFIRST);
+  uint16_t ambient = 0xFFFF;
+  readAmbient(&ambient);
+  return ambient;
+}
 
-  // Read the 16-bit value from the register
-  return als_result_reg.read();
+/*!
+ * @brief  Reads the Ambient Light Sensor (ALS) measurement result, telling a
+ * bus error apart from a reading.
+ * @param  ambient  Where to store the result, untouched if the read failed.
+ * @return True if the read succeeded, otherwise false.
+ */
+bool Adafruit_VCNL4020::readAmbient(uint16_t *ambient) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_READ_AMBIENT);
+
+  // Register #5 and #6 (Ambient Light Result Register), MSB-first
+  uint8_t buffer[2];
+  if (!busRead(VCNL4020_REG_AMBIENT_RESULT_HIGH, buffer, 2))
+    return false;
+  *ambient = ((uint16_t)buffer[0] << 8) | buffer[1];
+  return true;
+}
+
+/*!
+ * @brief  Reads the ambient light in lux. The result register already holds
+ * the average of the configured number of conversions, so the averaging
+ * setting does not change the scale.
+ * @return The ambient light in lux, 0.25 lx resolution, NAN if the read
+ * failed.
+ */
+float Adafruit_VCNL4020::readLux() {
+  float lux = NAN;
+  readLux(&lux);
+  return lux;
+}
+
+/*!
+ * @brief  Reads the ambient light in lux, telling a bus error apart from a
+ * reading.
+ * @param  lux  Where to store the result, untouched if the read failed.
+ * @return True if the read succeeded, otherwise false.
+ */
+bool Adafruit_VCNL4020::readLux(float *lux) {
+  uint16_t ambient;
+  if (!readAmbient(&ambient))
+    return false;
+  *lux = ambient * 0.25f;
+  return true;
+}
+
+/*!
+ * @brief  Reads the ambient light in milli-lux, with integer math only for
+ * MCUs without an FPU.
+ * @return The ambient light in milli-lux, 0xFFFFFFFF if the read failed.
+ */
+uint32_t Adafruit_VCNL4020::readMilliLux() {
+  uint32_t milliLux = 0xFFFFFFFF;
+  readMilliLux(&milliLux);
+  return milliLux;
+}
+
+/*!
+ * @brief  Reads the ambient light in milli-lux, telling a bus error apart
+ * from a reading.
+ * @param  milliLux  Where to store the result, untouched if the read failed.
+ * @return True if the read succeeded, otherwise false.
+ */
+bool Adafruit_VCNL4020::readMilliLux(uint32_t *milliLux) {
+  uint16_t ambient;
+  if (!readAmbient(&ambient))
+    return false;
+  *milliLux = countsToMilliLux(ambient);
+  return true;
+}
+
+/*!
+ * @brief  Converts a raw ambient result to milli-lux.
+ * @param  counts  The raw ambient result.
+ * @return The ambient light in milli-lux.
+ */
+uint32_t Adafruit_VCNL4020::countsToMilliLux(uint16_t counts) {
+  return (uint32_t)counts * VCNL4020_MILLILUX_PER_COUNT;
+}
+
+/*!
+ * @brief  Converts a raw ambient result to lux in Q16.16 fixed point.
+ * @param  counts  The raw ambient result.
+ * @return The ambient light in lux, times 65536.
+ */
+uint32_t Adafruit_VCNL4020::countsToLuxQ16(uint16_t counts) {
+  // 0.25 lx/count is exactly 2^14 in Q16.16
+  return (uint32_t)counts << 14;
+}
+
+/*!
+ * @brief  Converts an array of raw ambient results to milli-lux.
+ * @param  counts    The raw ambient results.
+ * @param  milliLux  Where to store the converted values, len entries.
+ * @param  len       How many values to convert.
+ */
+void Adafruit_VCNL4020::countsToMilliLux(const uint16_t *counts,
+                                         uint32_t *milliLux, uint16_t len) {
+  for (uint16_t i = 0; i < len; i++)
+    milliLux[i] = countsToMilliLux(counts[i]);
+}
+
+/*!
+ * @brief  Converts the ambient results of samples taken out of an
+ * Adafruit_VCNL4020_SampleBuffer to milli-lux.
+ * @param  samples   The samples.
+ * @param  milliLux  Where to store the converted values, len entries.
+ * @param  len       How many samples to convert.
+ */
+void Adafruit_VCNL4020::countsToMilliLux(const vcnl4020_timed_sample *samples,
+                                         uint32_t *milliLux, uint16_t len) {
+  for (uint16_t i = 0; i < len; i++)
+    milliLux[i] = countsToMilliLux(samples[i].ambient);
 }
 
 /*!
  * @brief  Reads the Proximity Measurement Result.
- * @return The 16-bit Proximity Measurement Result.
+ * @return The 16-bit Proximity Measurement Result, 0xFFFF if the read failed.
  */
 uint16_t Adafruit_VCNL4020::readProximity() {
-  // Create an I2C Register object for Register #7 and #8 (Proximity Measurement
-  // Result Register) The register is 2 bytes long and MSB-first
-  Adafruit_BusIO_Register proximity_result_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_PROX_RESULT_HIGH, 2, MSBFIRST);
+  uint16_t proximity = 0xFFFF;
+  readProximity(&proximity);
+  return proximity;
+}
+
+/*!
+ * @brief  Reads the Proximity Measurement Result, telling a bus error apart
+ * from a reading.
+ * @param  proximity  Where to store the result, untouched if the read failed.
+ * @return True if the read succeeded, otherwise false.
+ */
+bool Adafruit_VCNL4020::readProximity(uint16_t *proximity) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_READ_PROXIMITY);
 
-  // Read the 16-bit value from the register
-  return proximity_result_reg.read();
+  // Register #7 and #8 (Proximity Measurement Result Register), MSB-first
+  uint8_t buffer[2];
+  if (!busRead(VCNL4020_REG_PROX_RESULT_HIGH, buffer, 2))
+    return false;
+  uint16_t value = compensate(((uint16_t)buffer[0] << 8) | buffer[1]);
+
+  // Spurious 0xFFFF readings never reach the filter
+  if (_proxFilter && value != 0xFFFF) {
+    _proxFilter->push(value);
+    value = _proxFilter->output();
+  }
+  *proximity = value;
+  return true;
+}
+
+/*!
+ * @brief  Runs proximity results through an integer filter stage. With a
+ * filter set, readProximity() returns the filter output for every read, and
+ * Adafruit_VCNL4020_ProxStream::next() only returns a sample once per
+ * decimation period.
+ * @param  filter  The filter, or NULL to get raw results again. Must stay
+ * alive while set.
+ */
+void Adafruit_VCNL4020::setProxFilter(Adafruit_VCNL4020_Filter *filter) {
+  _proxFilter = filter;
+}
+
+/*!
+ * @brief  Reads the ambient and proximity results in one auto-incrementing
+ * burst, instead of one transaction per result plus one per ready flag.
+ * @param  sample      Where to store the results.
+ * @param  withStatus  True to start the burst at the command register (9
+ * bytes) so the ready flags are filled in, False to only read the 4 result
+ * bytes and leave both ready flags false.
+ * @return True if the read succeeded, otherwise false.
+ */
+bool Adafruit_VCNL4020::readSample(vcnl4020_sample *sample, bool withStatus) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_READ_SAMPLE);
+
+  // Registers #0 through #8, the result registers start at offset 5
+  uint8_t buffer[9];
+  uint8_t reg = withStatus ? VCNL4020_REG_COMMAND
+                           : VCNL4020_REG_AMBIENT_RESULT_HIGH;
+  uint8_t offset = withStatus ? 5 : 0;
+
+  if (!busRead(reg, buffer, offset + 4))
+    return false;
+
+  sample->ambientReady =
+      withStatus && vcnl4020_als_data_rdy_field::get(buffer[0]);
+  sample->proxReady =
+      withStatus && vcnl4020_prox_data_rdy_field::get(buffer[0]);
+  sample->ambient = ((uint16_t)buffer[offset] << 8) | buffer[offset + 1];
+  sample->proximity =
+      compensate(((uint16_t)buffer[offset + 2] << 8) | buffer[offset + 3]);
+  return true;
+}
+
+/*!
+ * @brief  Gets the time between two results of a channel in the current
+ * mode: the self-timed rate if self-timed measurements are on, else the
+ * on-demand conversion time.
+ * @param  channel  The channel.
+ * @return The period in microseconds.
+ */
+uint32_t Adafruit_VCNL4020::channelPeriodMicros(vcnl4020_channel channel) {
+  bool als = channel == VCNL4020_CHANNEL_AMBIENT;
+  if (!readField<vcnl4020_selftimed_en_field>())
+    return conversionMicros(als, !als);
+  if (als && !readField<vcnl4020_cont_conv_field>())
+    return ambientPeriodMicros(getAmbientRate());
+  if (als)
+    return conversionMicros(true, false);
+  return proxPeriodMicros(getProxRate());
+}
+
+/*!
+ * @brief  Gets the self-timed ambient measurement period for a rate.
+ * @param  rate  The rate, as defined in the vcnl4020_ambientrate enum.
+ * @return The time between two ambient conversions in microseconds.
+ */
+uint32_t Adafruit_VCNL4020::ambientPeriodMicros(vcnl4020_ambientrate rate) {
+  // 1, 2, 3, 4, 5, 6, 8 and 10 samples/s
+  static const uint32_t periods[] = {1000000, 500000, 333333, 250000,
+                                     200000,  166667, 125000, 100000};
+  return periods[rate & 0x07];
+}
+
+/*!
+ * @brief  Subtracts the crosstalk offsets of a calibration from proximity
+ * results, picking the offset of the current LED current and proximity
+ * frequency whenever they change. Adafruit_VCNL4020_Calibration sets itself
+ * here once it holds offsets.
+ * @param  calibration  The calibration, or NULL to get raw results again.
+ * Must stay alive while set.
+ */
+void Adafruit_VCNL4020::setProxCalibration(
+    Adafruit_VCNL4020_Calibration *calibration) {
+  _calibration = calibration;
+  _proxOffset = 0;
+  if (_shadowValid)
+    updateProxOffset();
+}
+
+/*!
+ * @brief  Gets the crosstalk offset subtracted at the current setting.
+ * @return The offset in proximity counts, 0 if the setting is not calibrated.
+ */
+uint16_t Adafruit_VCNL4020::getProxOffset() { return _proxOffset; }
+
+/*!
+ * @brief  Computes the CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) used to
+ * protect calibration blobs and telemetry frames.
+ * @param  data  The bytes to check.
+ * @param  len   How many bytes.
+ * @return The CRC.
+ */
+uint16_t Adafruit_VCNL4020::crc16(const uint8_t *data, uint16_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--) {
+    crc ^= (uint16_t)*data++ << 8;
+    for (uint8_t bit = 0; bit < 8; bit++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+/*!
+ * @brief  Looks up the crosstalk offset of the LED current and proximity
+ * frequency in the shadow cache, so the read path only subtracts.
+ */
+void Adafruit_VCNL4020::updateProxOffset() {
+  uint8_t ledCode = vcnl4020_led_current_field::get(
+      _shadow[vcnl4020_led_current_field::index]);
+  uint8_t frequency =
+      vcnl4020_prox_freq_field::get(_shadow[vcnl4020_prox_freq_field::index]);
+
+  _proxOffset = _calibration ? _calibration->getOffset(ledCode, frequency) : 0;
+}
+
+/*!
+ * @brief  Subtracts the crosstalk offset from a raw proximity result.
+ * @param  raw  The raw result.
+ * @return The compensated result, clamped at 0. 0xFFFF readings are passed
+ * on untouched so they can still be told apart as spurious.
+ */
+uint16_t Adafruit_VCNL4020::compensate(uint16_t raw) {
+  if (raw == 0xFFFF)
+    return raw;
+  return raw > _proxOffset ? raw - _proxOffset : 0;
 }
 
 /*!
  * @brief  Sets the Low Threshold for Proximity Measurement.
  * @param  threshold  The 16-bit Low Threshold value.
+ * @return True if the write was acknowledged, otherwise false.
  */
-void Adafruit_VCNL4020::setLowThreshold(uint16_t threshold) {
-  // Create an I2C Register object for Register #10 and #11 (Low Threshold)
-  Adafruit_BusIO_Register low_threshold_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_LOW_THRES_HIGH, 2, MSBFIRST);
+bool Adafruit_VCNL4020::setLowThreshold(uint16_t threshold) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_SET_THRESHOLDS);
 
-  // Write the 16-bit value to the register
-  low_threshold_reg.write(threshold);
+  // Register #10 and #11 (Low Threshold), MSB-first
+  uint8_t buffer[2] = {(uint8_t)(threshold >> 8), (uint8_t)threshold};
+  return writeRegisters(VCNL4020_REG_LOW_THRES_HIGH, buffer, 2);
 }
 
 /*!
@@ -443,25 +840,21 @@ void Adafruit_VCNL4020::setLowThreshold(uint16_t threshold) {
  * @return The 16-bit Low Threshold value.
  */
 uint16_t Adafruit_VCNL4020::getLowThreshold() {
-  // Create an I2C Register object for Register #10 and #11 (Low Threshold)
-  Adafruit_BusIO_Register low_threshold_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_LOW_THRES_HIGH, 2, MSBFIRST);
-
-  // Read the 16-bit value from the register
-  return low_threshold_reg.read();
+  return ((uint16_t)cachedRegister(VCNL4020_REG_LOW_THRES_HIGH) << 8) |
+         cachedRegister(VCNL4020_REG_LOW_THRES_LOW);
 }
 
 /*!
  * @brief  Sets the High Threshold for Proximity Measurement.
  * @param  threshold  The 16-bit High Threshold value.
+ * @return True if the write was acknowledged, otherwise false.
  */
-void Adafruit_VCNL4020::setHighThreshold(uint16_t threshold) {
-  // Create an I2C Register object for Register #12 and #13 (High Threshold)
-  Adafruit_BusIO_Register high_threshold_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_HIGH_THRES_HIGH, 2, MSBFIRST);
+bool Adafruit_VCNL4020::setHighThreshold(uint16_t threshold) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_SET_THRESHOLDS);
 
-  // Write the 16-bit value to the register
-  high_threshold_reg.write(threshold);
+  // Register #12 and #13 (High Threshold), MSB-first
+  uint8_t buffer[2] = {(uint8_t)(threshold >> 8), (uint8_t)threshold};
+  return writeRegisters(VCNL4020_REG_HIGH_THRES_HIGH, buffer, 2);
 }
 
 /*!
@@ -469,12 +862,23 @@ void Adafruit_VCNL4020::setHighThreshold(uint16_t threshold) {
  * @return The 16-bit High Threshold value.
  */
 uint16_t Adafruit_VCNL4020::getHighThreshold() {
-  // Create an I2C Register object for Register #12 and #13 (High Threshold)
-  Adafruit_BusIO_Register high_threshold_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_HIGH_THRES_HIGH, 2, MSBFIRST);
+  return ((uint16_t)cachedRegister(VCNL4020_REG_HIGH_THRES_HIGH) << 8) |
+         cachedRegister(VCNL4020_REG_HIGH_THRES_LOW);
+}
+
+/*!
+ * @brief  Sets both thresholds in one 4-byte burst over registers #10 through
+ * #13, instead of one transaction per threshold.
+ * @param  low   The 16-bit Low Threshold value.
+ * @param  high  The 16-bit High Threshold value.
+ * @return True if the write was acknowledged, otherwise false.
+ */
+bool Adafruit_VCNL4020::setThresholds(uint16_t low, uint16_t high) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_SET_THRESHOLDS);
 
-  // Read the 16-bit value from the register
-  return high_threshold_reg.read();
+  uint8_t buffer[4] = {(uint8_t)(low >> 8), (uint8_t)low, (uint8_t)(high >> 8),
+                       (uint8_t)high};
+  return writeRegisters(VCNL4020_REG_LOW_THRES_HIGH, buffer, 4);
 }
 
 /*!
@@ -487,53 +891,79 @@ uint16_t Adafruit_VCNL4020::getHighThreshold() {
  * @param  threshALS  True to enable Threshold ALS interrupt, False to disable.
  * @param  intCount   The interrupt count setting, as defined in the
  * vcnl4020_int_count enum.
+ * @return True if the write was acknowledged, otherwise false.
  */
-void Adafruit_VCNL4020::setInterruptConfig(bool proxReady, bool alsReady,
+bool Adafruit_VCNL4020::setInterruptConfig(bool proxReady, bool alsReady,
                                            bool thresh, bool threshALS,
                                            vcnl4020_int_count intCount) {
-  // Create an I2C Register object for Register #9 (INTERRUPT CONTROL REGISTER)
-  Adafruit_BusIO_Register interrupt_control_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_INT_CTRL);
-
-  // Create bit accessors for each field
-  Adafruit_BusIO_RegisterBits int_count_bits =
-      Adafruit_BusIO_RegisterBits(&interrupt_control_reg, 3, 5); // Bits 5, 6, 7
-  Adafruit_BusIO_RegisterBits prox_ready_bit =
-      Adafruit_BusIO_RegisterBits(&interrupt_control_reg, 1, 3); // Bit 3
-  Adafruit_BusIO_RegisterBits als_ready_bit =
-      Adafruit_BusIO_RegisterBits(&interrupt_control_reg, 1, 2); // Bit 2
-  Adafruit_BusIO_RegisterBits thresh_bit =
-      Adafruit_BusIO_RegisterBits(&interrupt_control_reg, 1, 1); // Bit 1
-  Adafruit_BusIO_RegisterBits thresh_als_bit =
-      Adafruit_BusIO_RegisterBits(&interrupt_control_reg, 1, 0); // Bit 0
-
-  // Write the values to the register bits
-  int_count_bits.write(intCount);
-  prox_ready_bit.write(proxReady ? 1 : 0);
-  als_ready_bit.write(alsReady ? 1 : 0);
-  thresh_bit.write(thresh ? 1 : 0);
-  thresh_als_bit.write(threshALS ? 1 : 0);
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_SET_INTERRUPT_CONFIG);
+
+  // Compose all of Register #9 (INTERRUPT CONTROL REGISTER) locally
+  uint8_t value = vcnl4020_int_count_field::put(intCount) |
+                  vcnl4020_int_prox_ready_field::put(proxReady) |
+                  vcnl4020_int_als_ready_field::put(alsReady) |
+                  vcnl4020_int_thresh_en_field::put(thresh) |
+                  vcnl4020_int_thresh_als_field::put(threshALS);
+
+  return writeInterruptControl(value);
+}
+
+/*!
+ * @brief  Writes the raw INTERRUPT CONTROL REGISTER #9 in a single
+ * transaction.
+ * @param  value  The register value, built from the VCNL4020_INTCTRL_* bits
+ * and a vcnl4020_int_count shifted by VCNL4020_INTCTRL_COUNT_SHIFT, or from
+ * the vcnl4020_int_*_field put() values.
+ * @return True if the write was acknowledged, otherwise false.
+ */
+bool Adafruit_VCNL4020::writeInterruptControl(uint8_t value) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_SET_INTERRUPT_CONFIG);
+
+  return writeRegister(VCNL4020_REG_INT_CTRL, value);
+}
+
+/*!
+ * @brief  Gets the raw INTERRUPT CONTROL REGISTER #9 from the shadow cache.
+ * @return The register value.
+ */
+uint8_t Adafruit_VCNL4020::getInterruptControl() {
+  return cachedRegister(VCNL4020_REG_INT_CTRL);
 }
 
 /*!
  * @brief  Gets the status of the interrupts from INTERRUPT STATUS REGISTER #14.
- * @return uint8_t containing the lower 4 bits of the INTERRUPT STATUS REGISTER.
+ * @return uint8_t containing the lower 4 bits of the INTERRUPT STATUS REGISTER,
+ * 0 if the read failed.
  */
 uint8_t Adafruit_VCNL4020::getInterruptStatus() {
-  // Create an I2C Register object for Register #14 (INTERRUPT STATUS REGISTER)
-  Adafruit_BusIO_Register int_status_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_INT_STATUS);
+  uint8_t int_status = 0;
+  getInterruptStatus(&int_status);
+  return int_status;
+}
 
-  // Read the value of the register
-  uint8_t int_status = int_status_reg.read();
+/*!
+ * @brief  Gets the status of the interrupts, telling a bus error apart from
+ * no interrupt pending.
+ * @param  status  Where to store the lower 4 bits of the INTERRUPT STATUS
+ * REGISTER, untouched if the read failed.
+ * @return True if the read succeeded, otherwise false.
+ */
+bool Adafruit_VCNL4020::getInterruptStatus(uint8_t *status) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_INTERRUPT_STATUS);
+
+  // Read Register #14 (INTERRUPT STATUS REGISTER)
+  uint8_t int_status;
+  if (!busRead(VCNL4020_REG_INT_STATUS, &int_status, 1))
+    return false;
 
   // Mask the lower 4 bits to get the interrupt status
-  return (int_status & 0x0F);
+  *status = int_status & 0x0F;
+  return true;
 }
 
 /*!
  * @brief  Clears the specified interrupt flags in INTERRUPT STATUS REGISTER
- * #14.
+ * #14, see clearInterruptMask().
  * @param  proxready  True to clear the Proximity Ready interrupt flag, False to
  * leave it.
  * @param  alsready   True to clear the ALS Ready interrupt flag, False to leave
@@ -542,16 +972,10 @@ uint8_t Adafruit_VCNL4020::getInterruptStatus() {
  * leave it.
  * @param  th_high    True to clear the High Threshold interrupt flag, False to
  * leave it.
+ * @return True if the write was acknowledged, otherwise false.
  */
-void Adafruit_VCNL4020::clearInterrupts(bool proxready, bool alsready,
+bool Adafruit_VCNL4020::clearInterrupts(bool proxready, bool alsready,
                                         bool th_low, bool th_high) {
-  // Create an I2C Register object for Register #14 (INTERRUPT STATUS REGISTER)
-  Adafruit_BusIO_Register int_status_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_INT_STATUS);
-
-  // Read the current value of the register
-  uint8_t int_status = int_status_reg.read();
-
   // Prepare the bits to be cleared
   uint8_t clear_bits = 0;
   if (proxready)
@@ -563,8 +987,50 @@ void Adafruit_VCNL4020::clearInterrupts(bool proxready, bool alsready,
   if (th_high)
     clear_bits |= VCNL4020_INT_TH_HI;
 
-  // Clear the specified bits by writing '1' to them
-  int_status_reg.write(int_status | clear_bits);
+  return clearInterruptMask(clear_bits);
+}
+
+/*!
+ * @brief  Clears exactly the given flags in INTERRUPT STATUS REGISTER #14 with
+ * a single write. The register is write-1-to-clear, so flags not in the mask
+ * are left alone and no read is needed.
+ * @param  mask  VCNL4020_INT_* flags to clear.
+ * @return True if the write was acknowledged, otherwise false.
+ */
+bool Adafruit_VCNL4020::clearInterruptMask(uint8_t mask) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_CLEAR_INTERRUPTS);
+
+  mask &= 0x0F;
+  return busWrite(VCNL4020_REG_INT_STATUS, &mask, 1);
+}
+
+/*!
+ * @brief  Reads INTERRUPT STATUS REGISTER #14 and acknowledges exactly the
+ * flags that were set, one read plus at most one write. Flags raised after
+ * the read stay pending.
+ * @return The VCNL4020_INT_* flags that were set and are now cleared, 0 if
+ * the read failed.
+ */
+uint8_t Adafruit_VCNL4020::readAndClearInterrupts() {
+  uint8_t status = 0;
+  readAndClearInterrupts(&status);
+  return status;
+}
+
+/*!
+ * @brief  Reads and acknowledges the interrupt flags like
+ * readAndClearInterrupts(), telling bus errors apart from no flags set.
+ * @param  status  Where to store the VCNL4020_INT_* flags that were read,
+ * untouched if the read failed.
+ * @return True if the flags were read and acknowledged, false if the read or
+ * the acknowledge failed. In the latter case the flags stay pending.
+ */
+bool Adafruit_VCNL4020::readAndClearInterrupts(uint8_t *status) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_CLEAR_INTERRUPTS);
+
+  if (!getInterruptStatus(status))
+    return false;
+  return *status == 0 || clearInterruptMask(*status);
 }
 
 /*!
@@ -572,19 +1038,12 @@ void Adafruit_VCNL4020::clearInterrupts(bool proxready, bool alsready,
  * Timing Adjustment.
  * @param  freq  The proximity frequency setting, as defined in the
  * vcnl4020_proxfreq enum.
+ * @return True if the write was acknowledged, otherwise false.
  */
-void Adafruit_VCNL4020::setProxFrequency(vcnl4020_proxfreq freq) {
-  // Create an I2C Register object for Register #15 (Proximity Modulator Timing
-  // Adjustment)
-  Adafruit_BusIO_Register prox_mod_timing_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_PROX_ADJUST);
-
-  // Create bit accessors for Proximity Frequency (Bits 2 and 3)
-  Adafruit_BusIO_RegisterBits prox_freq_bits = Adafruit_BusIO_RegisterBits(
-      &prox_mod_timing_reg, 2, 3); // 2 bits starting at bit 3
+bool Adafruit_VCNL4020::setProxFrequency(vcnl4020_proxfreq freq) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_SET_PROX_CONFIG);
 
-  // Write the value to the register bits
-  prox_freq_bits.write(freq);
+  return writeField<vcnl4020_prox_freq_field>(freq);
 }
 
 /*!
@@ -592,9 +1051,475 @@ void Adafruit_VCNL4020::setProxFrequency(vcnl4020_proxfreq freq) {
  * @return  The current proximity frequency setting.
  */
 vcnl4020_proxfreq Adafruit_VCNL4020::getProxFrequency() {
-  Adafruit_BusIO_Register prox_timing_reg =
-      Adafruit_BusIO_Register(_i2c, VCNL4020_REG_PROX_ADJUST);
-  Adafruit_BusIO_RegisterBits proxfreq_bits = Adafruit_BusIO_RegisterBits(
-      &prox_timing_reg, 2, 3); // 2 bits starting at bit 3
-  return (vcnl4020_proxfreq)proxfreq_bits.read();
+  return (vcnl4020_proxfreq)readField<vcnl4020_prox_freq_field>();
+}
+
+/*!
+ * @brief  Tells the driver which pin the INT output is wired to. Optional, but
+ * lets fetchInterruptSample() notice an interrupt that is still held low when
+ * a new measurement landed before the previous one was acknowledged.
+ * @param  pin  The pin number, or -1 to forget it.
+ */
+void Adafruit_VCNL4020::setInterruptPin(int8_t pin) { _intPin = pin; }
+
+/*!
+ * @brief  Records an INT pin edge. Safe to call from an interrupt handler, it
+ * does no I2C and only stores the time so the sample can be fetched later by
+ * fetchInterruptSample() or serviceInterrupt(). Attach on the FALLING edge,
+ * the INT output is active low.
+ */
+void Adafruit_VCNL4020::handleInterrupt() { handleInterrupt(now()); }
+
+/*!
+ * @brief  Records an INT pin edge that happened at a given time, e.g. from a
+ * timer input capture or a replayed trace. Safe to call from an interrupt
+ * handler.
+ * @param  timestamp  micros() of the edge.
+ */
+void Adafruit_VCNL4020::handleInterrupt(uint32_t timestamp) {
+  _intMicros = timestamp;
+  _intPending = true;
+}
+
+/*!
+ * @brief  Fetches the sample announced by the INT pin, if any: one burst over
+ * registers #5 through #14 reads both results together with the interrupt
+ * status, then one write acknowledges exactly the flags that were read.
+ * @param  sample  Where to store the timestamped sample.
+ * @return True if an interrupt was pending, the sample was read and the flags
+ * were acknowledged. If the read or the acknowledge fails INT stays asserted
+ * and no new edge will come, so the edge is recorded as pending again and the
+ * sample is fetched on the next call, with or without setInterruptPin().
+ */
+bool Adafruit_VCNL4020::fetchInterruptSample(vcnl4020_timed_sample *sample) {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_SERVICE_INTERRUPT);
+
+  noInterrupts();
+  bool pending = _intPending;
+  uint32_t timestamp = _intMicros;
+  _intPending = false;
+  interrupts();
+
+  if (!pending) {
+    if (_intPin < 0 || digitalRead(_intPin) != LOW)
+      return false;
+    timestamp = now();
+  }
+  tapInterrupt(timestamp);
+
+  // Registers #5 through #8 hold the results, #14 the interrupt status
+  uint8_t buffer[10];
+  if (!busRead(VCNL4020_REG_AMBIENT_RESULT_HIGH, buffer, 10)) {
+    handleInterrupt(timestamp);
+    return false;
+  }
+  uint8_t status = buffer[9] & 0x0F;
+  if (status == 0)
+    return false;
+
+  // Acknowledge exactly the flags we are reporting
+  if (!clearInterruptMask(status)) {
+    handleInterrupt(timestamp);
+    return false;
+  }
+
+  sample->timestamp = timestamp;
+  sample->ambient = ((uint16_t)buffer[0] << 8) | buffer[1];
+  sample->proximity = compensate(((uint16_t)buffer[2] << 8) | buffer[3]);
+  sample->status = status;
+  return true;
+}
+
+/*!
+ * @brief  Estimates how long an on-demand measurement takes with the current
+ * ambient averaging. Roughly 1 ms per averaged ALS conversion and well under
+ * 1 ms for proximity.
+ * @param  als   True if an ALS measurement is included.
+ * @param  prox  True if a proximity measurement is included.
+ * @return The expected conversion time in microseconds.
+ */
+uint32_t Adafruit_VCNL4020::conversionMicros(bool als, bool prox) {
+  uint32_t expect = 0;
+  if (als)
+    expect += 1000UL << getAmbientAveraging();
+  if (prox)
+    expect += 1000;
+  return expect;
+}
+
+/*!
+ * @brief  Gets the self-timed proximity measurement period for a rate.
+ * @param  rate  The rate, as defined in the vcnl4020_proxrate enum.
+ * @return The time between two proximity conversions in microseconds.
+ */
+uint32_t Adafruit_VCNL4020::proxPeriodMicros(vcnl4020_proxrate rate) {
+  // 1.95, 3.90625, 7.8125, 16.625, 31.25, 62.5, 125 and 250 measurements/s
+  static const uint32_t periods[] = {512821, 256000, 128000, 60150,
+                                     32000,  16000,  8000,   4000};
+  return periods[rate & 0x07];
+}
+
+/*!
+ * @brief  Reads registers #0 through #15 into the shadow cache in a single
+ * burst. Configuration getters are answered from this cache, so call it
+ * whenever something other than this driver may have changed the chip.
+ * @return True if the registers were read, otherwise false.
+ */
+bool Adafruit_VCNL4020::syncRegisters() {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_SYNC_REGISTERS);
+
+  _shadowValid = busRead(VCNL4020_REG_FIRST, _shadow, VCNL4020_REG_COUNT);
+
+  // Only the enable bits of the command register are kept, the rest are
+  // status or self-clearing trigger bits
+  _shadow[vcnl4020_enables_field::index] &= vcnl4020_enables_field::mask;
+  if (_shadowValid)
+    updateProxOffset();
+  return _shadowValid;
+}
+
+/*!
+ * @brief  Brings the chip back to the configuration this driver last set,
+ * e.g. after a brown-out reset or a run of bus errors, without the probe
+ * retries and delays of begin(). Costs one burst read of the register map
+ * plus writes of only the registers that differ.
+ * @return True if the chip answered and holds the configuration again.
+ */
+bool Adafruit_VCNL4020::recover() {
+  VCNL4020_STATS_SCOPE(VCNL4020_OP_RECOVER);
+
+  if (!_knownValid)
+    return false;
+
+  uint8_t target[VCNL4020_REG_COUNT];
+  memcpy(target, _known, VCNL4020_REG_COUNT);
+  if (!syncRegisters() || getProdRevision() != 0x21)
+    return false;
+  return writeDifferences(target);
+}
+
+/*!
+ * @brief  Sets how many times a failed bus transaction is retried before the
+ * driver call gives up and reports the error.
+ * @param  reads   Retries for register reads, 0 for none.
+ * @param  writes  Retries for register writes, 0 for none.
+ */
+void Adafruit_VCNL4020::setRetries(uint8_t reads, uint8_t writes) {
+  _readRetries = reads;
+  _writeRetries = writes;
+}
+
+/*!
+ * @brief  Gets the number of bus transactions that failed even after the
+ * retries set with setRetries().
+ * @return The error count since construction, wraps.
+ */
+uint32_t Adafruit_VCNL4020::getBusErrors() { return _busErrors; }
+
+/*!
+ * @brief  Marks the shadow cache as stale, the next configuration getter or
+ * setter will re-read the registers from the chip first.
+ */
+void Adafruit_VCNL4020::invalidateRegisters() { _shadowValid = false; }
+
+/*!
+ * @brief  Makes sure the shadow cache is valid, re-reading the registers if
+ * it is stale.
+ * @return True if the cache is valid, false if the registers could not be
+ * read.
+ */
+bool Adafruit_VCNL4020::refreshRegisters() {
+  return _shadowValid || syncRegisters();
+}
+
+/*!
+ * @brief  Returns the cached value of a register, refreshing the cache first
+ * if it is not valid. Callers that can report an error check
+ * refreshRegisters() first.
+ * @param  reg  The register address, 0x80 - 0x8F.
+ * @return The cached register value, stale if the refresh failed.
+ */
+uint8_t Adafruit_VCNL4020::cachedRegister(uint8_t reg) {
+  refreshRegisters();
+  return _shadow[reg - VCNL4020_REG_FIRST];
+}
+
+/*!
+ * @brief  Writes a single register and updates the shadow cache.
+ * @param  reg    The register address, 0x80 - 0x8F.
+ * @param  value  The value to write.
+ * @return True if the write was acknowledged, otherwise false.
+ */
+bool Adafruit_VCNL4020::writeRegister(uint8_t reg, uint8_t value) {
+  return writeRegisters(reg, &value, 1);
+}
+
+/*!
+ * @brief  Writes consecutive registers in one auto-incrementing transaction
+ * and updates the shadow cache and the state recover() restores.
+ * @param  reg     The first register address, 0x80 - 0x8F.
+ * @param  buffer  The values to write.
+ * @param  len     How many registers to write.
+ * @return True if the write was acknowledged, otherwise false.
+ */
+bool Adafruit_VCNL4020::writeRegisters(uint8_t reg, const uint8_t *buffer,
+                                       uint8_t len) {
+  // Remember what was asked for even if it fails, recover() writes it again
+  memcpy(&_known[reg - VCNL4020_REG_FIRST], buffer, len);
+  _known[vcnl4020_enables_field::index] &= vcnl4020_enables_field::mask;
+
+  if (!busWrite(reg, buffer, len)) {
+    // We no longer know what the chip holds
+    _shadowValid = false;
+    return false;
+  }
+  memcpy(&_shadow[reg - VCNL4020_REG_FIRST], buffer, len);
+  updateProxOffset();
+  return true;
+}
+
+/*!
+ * @brief  Replaces some bits of a register from the shadow cache and writes
+ * it, without reading the register back first.
+ * @param  reg   The register address, 0x80 - 0x8F.
+ * @param  mask  The bits to replace.
+ * @param  bits  The new values of those bits, already in place.
+ * @return True if the write was acknowledged, false if it failed or the
+ * cache was stale and could not be refreshed.
+ */
+bool Adafruit_VCNL4020::writeMasked(uint8_t reg, uint8_t mask, uint8_t bits) {
+  // The other bits come from the cache, so it must hold the chip's values
+  if (!refreshRegisters())
+    return false;
+  return writeRegister(reg, (cachedRegister(reg) & ~mask) | (bits & mask));
+}
+
+/*!
+ * @brief  Tells whether a register holds configuration, as opposed to the
+ * command, product ID, result and interrupt status registers.
+ * @param  index  The register number, 0 - 15.
+ * @return True for the parameter registers applyConfig() programs.
+ */
+bool Adafruit_VCNL4020::isConfigRegister(uint8_t index) {
+  return (index >= 2 && index <= 4) || (index >= 9 && index <= 13) ||
+         (index == 15);
+}
+
+/*!
+ * @brief  Tells whether a register may only be changed while measurements are
+ * disabled: the proximity rate, LED current, ambient parameters and modulator
+ * timing. Interrupt control and thresholds can change on the fly.
+ * @param  index  The register number, 0 - 15.
+ * @return True for registers #2, #3, #4 and #15.
+ */
+bool Adafruit_VCNL4020::needsPause(uint8_t index) {
+  return (index >= 2 && index <= 4) || (index == 15);
+}
+
+/*!
+ * @brief  Reads consecutive registers in one auto-incrementing transaction,
+ * retrying as set by setRetries(). Every register read in this driver goes
+ * through here.
+ * @param  reg     The first register address.
+ * @param  buffer  Where to store the values.
+ * @param  len     How many registers to read.
+ * @return True if the read was acknowledged, otherwise false.
+ */
+bool Adafruit_VCNL4020::busRead(uint8_t reg, uint8_t *buffer, uint8_t len) {
+  if (!_i2c && !_busReplay)
+    return false;
+
+  for (uint8_t attempt = 0;; attempt++) {
+    if (transfer(reg, NULL, buffer, len))
+      return true;
+    if (attempt >= _readRetries)
+      break;
+  }
+  _busErrors++;
+  return false;
+}
+
+/*!
+ * @brief  Writes consecutive registers in one auto-incrementing transaction,
+ * retrying as set by setRetries(), without touching the shadow cache. Every
+ * register write in this driver goes through here.
+ * @param  reg     The first register address.
+ * @param  buffer  The values to write.
+ * @param  len     How many registers to write.
+ * @return True if the write was acknowledged, otherwise false.
+ */
+bool Adafruit_VCNL4020::busWrite(uint8_t reg, const uint8_t *buffer,
+                                 uint8_t len) {
+  if (!_i2c && !_busReplay)
+    return false;
+
+  for (uint8_t attempt = 0;; attempt++) {
+    if (transfer(reg, buffer, NULL, len))
+      return true;
+    if (attempt >= _writeRetries)
+      break;
+  }
+  _busErrors++;
+  return false;
+}
+
+/*!
+ * @brief  Does one bus transaction, on the I2C bus or against the replay
+ * function, and shows it to the bus tap and the statistics.
+ * @param  reg  The first register address.
+ * @param  out  The values to write, or NULL for a read.
+ * @param  in   Where to store the values read, or NULL for a write.
+ * @param  len  How many registers to read or write.
+ * @return True if the transaction was acknowledged, otherwise false.
+ */
+bool Adafruit_VCNL4020::transfer(uint8_t reg, const uint8_t *out, uint8_t *in,
+                                 uint8_t len) {
+#ifdef VCNL4020_ENABLE_STATS
+  uint32_t start = micros();
+#endif
+
+  vcnl4020_bus_event event;
+  event.type = out ? VCNL4020_BUS_WRITE : VCNL4020_BUS_READ;
+  event.timestamp = (_busTap || _busReplay) ? now() : 0;
+  event.reg = reg;
+  event.len = len;
+  event.ok = false;
+  event.data = out ? out : in;
+
+  if (_busReplay)
+    event.ok = _busReplay(&event, in);
+  else if (out)
+    event.ok = _i2c->write(out, len, true, &reg, 1);
+  else
+    event.ok = _i2c->write_then_read(&reg, 1, in, len);
+
+#ifdef VCNL4020_ENABLE_STATS
+  countTransaction(out != NULL, 1 + len, micros() - start);
+#endif
+  if (_busTap)
+    _busTap(&event);
+  return event.ok;
+}
+
+/*!
+ * @brief  Shows an INT edge that the driver is about to service to the bus
+ * tap, so a trace records when it happened.
+ * @param  timestamp  micros() of the edge.
+ */
+void Adafruit_VCNL4020::tapInterrupt(uint32_t timestamp) {
+  if (!_busTap)
+    return;
+  vcnl4020_bus_event event = {VCNL4020_BUS_INT, timestamp, 0, 0, true, NULL};
+  _busTap(&event);
+}
+
+/*!
+ * @brief  Sets a function that sees every bus transaction and serviced INT
+ * edge, in order, e.g. to capture a trace of a live sensor with
+ * Adafruit_VCNL4020_Trace::print().
+ * @param  tap  The function, or NULL for none. Called from the driver call
+ * that made the transaction, never from an interrupt handler.
+ */
+void Adafruit_VCNL4020::setBusTap(vcnl4020_bus_tap tap) { _busTap = tap; }
+
+/*!
+ * @brief  Replays a captured trace instead of talking to the chip: every
+ * transaction goes to the replay function, which answers reads from the trace
+ * and can check that writes match it. Feed the trace's INT edges to
+ * handleInterrupt(uint32_t) before the driver call that serviced them, and
+ * drive setClock() from the trace timestamps. Use fastBegin(), begin()
+ * probes the real bus.
+ * @param  replay  The function, or NULL to talk to the chip again.
+ */
+void Adafruit_VCNL4020::setBusReplay(vcnl4020_bus_replay replay) {
+  _busReplay = replay;
+}
+
+/*!
+ * @brief  Sets where the driver, and the add-on classes built on it, take
+ * the time from: stream pacing and drop counting, interrupt and record
+ * timestamps, measurement timeouts and trace timestamps. When replaying, a
+ * clock that returns the timestamp of the next trace event makes the driver
+ * take the same timing decisions it took while the trace was captured. Bus
+ * statistics keep timing the real bus with micros().
+ * @param  clock  The time source in microseconds, or NULL for micros(). Must
+ * be safe to call from an interrupt handler if handleInterrupt() is.
+ */
+void Adafruit_VCNL4020::setClock(vcnl4020_clock clock) { _clock = clock; }
+
+/*!
+ * @brief  Gets the time from the clock set with setClock().
+ * @return The time in microseconds, micros() unless a clock was set.
+ */
+uint32_t Adafruit_VCNL4020::now() { return _clock ? _clock() : micros(); }
+
+#ifdef VCNL4020_ENABLE_STATS
+/*!
+ * @brief  Gets the bus statistics collected for one group of driver calls.
+ * @param  op  Which group of calls, VCNL4020_OP_TOTAL for everything.
+ * @return The counters, zeroed by resetStats().
+ */
+vcnl4020_stats Adafruit_VCNL4020::getStats(vcnl4020_stat_op op) {
+  if (op < VCNL4020_OP_TOTAL)
+    return _stats[op];
+
+  vcnl4020_stats total = {0, 0, 0, 0, 0};
+  for (uint8_t i = 0; i < VCNL4020_OP_TOTAL; i++) {
+    total.calls += _stats[i].calls;
+    total.reads += _stats[i].reads;
+    total.writes += _stats[i].writes;
+    total.bytes += _stats[i].bytes;
+    total.busMicros += _stats[i].busMicros;
+  }
+  return total;
+}
+
+/*!
+ * @brief  Zeroes all bus statistics.
+ */
+void Adafruit_VCNL4020::resetStats() { memset(_stats, 0, sizeof(_stats)); }
+
+/*!
+ * @brief  Adds one bus transaction to the statistics of the current call.
+ * @param  write    True for a write, false for a read.
+ * @param  bytes    Bytes moved including the register address.
+ * @param  elapsed  Time spent on the bus in microseconds.
+ */
+void Adafruit_VCNL4020::countTransaction(bool write, uint8_t bytes,
+                                         uint32_t elapsed) {
+  vcnl4020_stats *stats = &_stats[_statsOp];
+  if (write)
+    stats->writes++;
+  else
+    stats->reads++;
+  stats->bytes += bytes;
+  stats->busMicros += elapsed;
+}
+
+/*!
+ * @brief  Starts attributing bus traffic to op, unless an outer driver call
+ * already is (e.g. begin() calling applyConfig()).
+ * @param  dev  The driver instance.
+ * @param  op   The group of calls being entered.
+ */
+Adafruit_VCNL4020::StatsScope::StatsScope(Adafruit_VCNL4020 *dev,
+                                          vcnl4020_stat_op op) {
+  _dev = dev;
+  _outer = !dev->_statsBusy;
+  if (_outer) {
+    dev->_statsBusy = true;
+    dev->_statsOp = op;
+    dev->_stats[op].calls++;
+  }
+}
+
+/*!
+ * @brief  Stops attributing bus traffic to the op of the outermost call.
+ */
+Adafruit_VCNL4020::StatsScope::~StatsScope() {
+  if (_outer) {
+    _dev->_statsBusy = false;
+    _dev->_statsOp = VCNL4020_OP_OTHER;
+  }
 }
+#endif
@@ -22,9 +22,16 @@
 #define ADAFRUIT_VCNL4020_H
 
 #include "Arduino.h"
+#include "Adafruit_VCNL4020_Filter.h"
+#include "Adafruit_VCNL4020_SampleBuffer.h"
 #include <Adafruit_BusIO_Register.h>
 
 #define VCNL4020_I2C_ADDRESS 0x13 ///< The address is fixed
+#define VCNL4020_MILLILUX_PER_COUNT 250 ///< Ambient resolution, 0.25 lx/count
+
+// Uncomment (or pass -DVCNL4020_ENABLE_STATS) to count bus transactions per
+// driver call, see getStats(). Adds RAM and a micros() call per transaction.
+// #define VCNL4020_ENABLE_STATS
 
 ///< VCNL4020 Register Definitions
 #define VCNL4020_REG_COMMAND 0x80 ///< Register #0 Command Register
@@ -56,6 +63,72 @@
 #define VCNL4020_REG_PROX_ADJUST                                               \
   0x8F ///< Register #15 Proximity adjustment register
 
+#define VCNL4020_REG_FIRST VCNL4020_REG_COMMAND ///< First register in the map
+#define VCNL4020_REG_COUNT 16 ///< Registers #0 through #15 (0x80 - 0x8F)
+
+/*!
+ * @brief Compile-time description of a bit field in one VCNL4020 register.
+ * Masks and shifts fold into constants, and fields of the same register can
+ * be merged into a single write by OR-ing their masks and put() values.
+ * @tparam REG   The register address, 0x80 - 0x8F.
+ * @tparam BITS  The width of the field.
+ * @tparam SHIFT The position of the lowest bit of the field.
+ */
+template <uint8_t REG, uint8_t BITS, uint8_t SHIFT>
+struct Adafruit_VCNL4020_Field {
+  static const uint8_t reg = REG; ///< Register address
+  static const uint8_t index = REG - VCNL4020_REG_FIRST; ///< Register number
+  static const uint8_t mask = ((1 << BITS) - 1) << SHIFT; ///< Bits in place
+
+  /*!
+   * @brief  Extracts the field from a register value.
+   * @param  regval  The register value.
+   * @return The field value.
+   */
+  static uint8_t get(uint8_t regval) { return (regval & mask) >> SHIFT; }
+
+  /*!
+   * @brief  Moves a field value into place.
+   * @param  value  The field value.
+   * @return The field bits, ready to OR into the register value.
+   */
+  static uint8_t put(uint8_t value) { return (value << SHIFT) & mask; }
+
+  /*!
+   * @brief  Replaces the field in a register value.
+   * @param  regval  The register value.
+   * @param  value   The new field value.
+   * @return The updated register value.
+   */
+  static uint8_t set(uint8_t regval, uint8_t value) {
+    return (regval & ~mask) | put(value);
+  }
+};
+
+// clang-format off
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_COMMAND, 1, 6> vcnl4020_als_data_rdy_field;  ///< Command #6
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_COMMAND, 1, 5> vcnl4020_prox_data_rdy_field; ///< Command #5
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_COMMAND, 1, 4> vcnl4020_als_od_field;        ///< Command #4
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_COMMAND, 1, 3> vcnl4020_prox_od_field;       ///< Command #3
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_COMMAND, 1, 2> vcnl4020_als_en_field;        ///< Command #2
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_COMMAND, 1, 1> vcnl4020_prox_en_field;       ///< Command #1
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_COMMAND, 1, 0> vcnl4020_selftimed_en_field;  ///< Command #0
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_COMMAND, 3, 0> vcnl4020_enables_field;       ///< Command #2-0
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_PROX_RATE, 3, 0> vcnl4020_prox_rate_field;   ///< Prox rate
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_IR_LED_CURRENT, 6, 0> vcnl4020_led_current_field; ///< 10 mA units
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_AMBIENT_PARAM, 1, 7> vcnl4020_cont_conv_field;     ///< Continuous conversion
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_AMBIENT_PARAM, 3, 4> vcnl4020_ambient_rate_field;  ///< Ambient rate
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_AMBIENT_PARAM, 1, 3> vcnl4020_auto_offset_field;   ///< Auto offset compensation
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_AMBIENT_PARAM, 3, 0> vcnl4020_averaging_field;     ///< Ambient averaging
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_INT_CTRL, 3, 5> vcnl4020_int_count_field;          ///< INT_COUNT
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_INT_CTRL, 1, 3> vcnl4020_int_prox_ready_field;     ///< INT on prox ready
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_INT_CTRL, 1, 2> vcnl4020_int_als_ready_field;      ///< INT on ALS ready
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_INT_CTRL, 1, 1> vcnl4020_int_thresh_en_field;      ///< INT on threshold
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_INT_CTRL, 1, 0> vcnl4020_int_thresh_als_field;     ///< Threshold on ALS
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_INT_CTRL, 4, 0> vcnl4020_int_sources_field;        ///< INT sources, #3-0
+typedef Adafruit_VCNL4020_Field<VCNL4020_REG_PROX_ADJUST, 2, 3> vcnl4020_prox_freq_field;       ///< Prox frequency
+// clang-format on
+
 // clang-format off
 
 /** The measurements-per-second for automatic proximity sensing */
@@ -119,8 +192,117 @@ typedef enum {
 #define VCNL4020_INT_ALS_READY  0x04 ///< ALS ready
 #define VCNL4020_INT_PROX_READY 0x08 ///< Proximity ready
 
+#define VCNL4020_INTCTRL_THRESH_ALS   0x01 ///< Threshold applies to ALS
+#define VCNL4020_INTCTRL_THRESH_EN    0x02 ///< Threshold interrupt enable
+#define VCNL4020_INTCTRL_ALS_READY    0x04 ///< ALS ready interrupt enable
+#define VCNL4020_INTCTRL_PROX_READY   0x08 ///< Proximity ready interrupt enable
+#define VCNL4020_INTCTRL_COUNT_SHIFT  5    ///< Position of the INT_COUNT field
+
 // clang-format on
 
+/** One ambient + proximity reading fetched in a single bus transaction */
+typedef struct {
+  uint16_t ambient;   ///< Ambient light result, registers #5 and #6
+  uint16_t proximity; ///< Proximity result, registers #7 and #8
+  bool ambientReady;  ///< als_data_rdy was set when the sample was read
+  bool proxReady;     ///< prox_data_rdy was set when the sample was read
+} vcnl4020_sample;
+
+/** A measurement channel of the chip, see channelPeriodMicros() */
+typedef enum {
+  VCNL4020_CHANNEL_AMBIENT = 0,  ///< Ambient light result
+  VCNL4020_CHANNEL_PROXIMITY = 1 ///< Proximity result
+} vcnl4020_channel;
+
+/** Everything begin() programs, applied in one go by applyConfig() */
+typedef struct {
+  vcnl4020_proxrate proxRate;          ///< Register #2 proximity rate
+  uint8_t proxLEDmA;                   ///< Register #3 LED current in mA
+  vcnl4020_ambientrate ambientRate;    ///< Register #4 ambient rate
+  vcnl4020_averaging ambientAveraging; ///< Register #4 ambient averaging
+  bool continuousConversion;           ///< Register #4 continuous conversion
+  bool autoOffsetComp;                 ///< Register #4 auto offset compensation
+  uint8_t interruptControl; ///< Raw register #9, see writeInterruptControl()
+  uint16_t lowThreshold;    ///< Registers #10 and #11
+  uint16_t highThreshold;   ///< Registers #12 and #13
+  vcnl4020_proxfreq proxFrequency; ///< Register #15 proximity frequency
+  bool alsEnable;                  ///< Register #0 ALS enable
+  bool proxEnable;                 ///< Register #0 proximity enable
+  bool selfTimed;                  ///< Register #0 self-timed enable
+} vcnl4020_config;
+
+/** Kinds of vcnl4020_bus_event */
+typedef enum {
+  VCNL4020_BUS_READ,  ///< Register read
+  VCNL4020_BUS_WRITE, ///< Register write
+  VCNL4020_BUS_INT    ///< INT pin edge picked up by the driver
+} vcnl4020_bus_event_type;
+
+/** One bus transaction or INT edge, see setBusTap() and setBusReplay() */
+typedef struct {
+  vcnl4020_bus_event_type type; ///< What happened
+  uint32_t timestamp;           ///< micros() at the start, or of the INT edge
+  uint8_t reg;                  ///< First register address, 0 for INT edges
+  uint8_t len;                  ///< Bytes read or written after the address
+  bool ok;                      ///< True if the transaction was acknowledged
+  const uint8_t *data;          ///< The len bytes read or written
+} vcnl4020_bus_event;
+
+/** Called with every bus transaction and INT edge, e.g. to capture a trace */
+typedef void (*vcnl4020_bus_tap)(const vcnl4020_bus_event *event);
+
+/**
+ * Stands in for the chip when replaying a trace: fills readData for reads,
+ * may check writes against the trace, and returns the acknowledge to report.
+ */
+typedef bool (*vcnl4020_bus_replay)(const vcnl4020_bus_event *event,
+                                    uint8_t *readData);
+
+/**
+ * Time source of the driver in microseconds, see setClock(). Replay drives it
+ * from the trace timestamps.
+ */
+typedef uint32_t (*vcnl4020_clock)();
+
+/** Groups of driver calls that bus statistics are collected for */
+typedef enum {
+  VCNL4020_OP_BEGIN,                ///< begin()
+  VCNL4020_OP_APPLY_CONFIG,         ///< applyConfig()
+  VCNL4020_OP_SYNC_REGISTERS,       ///< syncRegisters()
+  VCNL4020_OP_ENABLE,               ///< enable()
+  VCNL4020_OP_ON_DEMAND,            ///< setOnDemand()
+  VCNL4020_OP_SET_PROX_CONFIG,      ///< setProxRate/LEDmA/Frequency()
+  VCNL4020_OP_SET_AMBIENT_CONFIG,   ///< setAmbient*(), ALS parameter setters
+  VCNL4020_OP_SET_THRESHOLDS,       ///< set*Threshold(), setThresholds()
+  VCNL4020_OP_SET_INTERRUPT_CONFIG, ///< setInterruptConfig() and friends
+  VCNL4020_OP_DATA_READY,           ///< isAmbientReady(), isProxReady()
+  VCNL4020_OP_READ_AMBIENT,         ///< readAmbient()
+  VCNL4020_OP_READ_PROXIMITY,       ///< readProximity()
+  VCNL4020_OP_READ_SAMPLE,          ///< readSample()
+  VCNL4020_OP_READ_RECORDS,         ///< Adafruit_VCNL4020_Recorder
+  VCNL4020_OP_INTERRUPT_STATUS,     ///< getInterruptStatus()
+  VCNL4020_OP_CLEAR_INTERRUPTS,     ///< clearInterrupts() and friends
+  VCNL4020_OP_SERVICE_INTERRUPT,    ///< fetchInterruptSample()
+  VCNL4020_OP_PROX_STREAM,          ///< Adafruit_VCNL4020_ProxStream
+  VCNL4020_OP_MEASUREMENT,          ///< Adafruit_VCNL4020_Measurement
+  VCNL4020_OP_THRESHOLD_TRACKING,   ///< Adafruit_VCNL4020_Tracker
+  VCNL4020_OP_RECOVER,              ///< recover()
+  VCNL4020_OP_CALIBRATE,            ///< Adafruit_VCNL4020_Calibration
+  VCNL4020_OP_OTHER,                ///< Anything not listed above
+  VCNL4020_OP_TOTAL                 ///< Sum of all of the above
+} vcnl4020_stat_op;
+
+/** Bus statistics for one group of driver calls */
+typedef struct {
+  uint32_t calls;     ///< Number of driver calls
+  uint32_t reads;     ///< Read transactions
+  uint32_t writes;    ///< Write transactions
+  uint32_t bytes;     ///< Bytes moved, including register addresses
+  uint32_t busMicros; ///< micros() spent inside bus transactions
+} vcnl4020_stats;
+
+class Adafruit_VCNL4020_Calibration;
+
 /*!
  * @brief Class that stores state and functions for interacting with VCNL4020
  * sensor.
@@ -129,55 +311,240 @@ class Adafruit_VCNL4020 {
 public:
   Adafruit_VCNL4020();
   bool begin(TwoWire *theWire = &Wire, uint8_t addr = VCNL4020_I2C_ADDRESS);
+  bool begin(const vcnl4020_config *config, TwoWire *theWire = &Wire,
+             uint8_t addr = VCNL4020_I2C_ADDRESS);
+  bool fastBegin(const vcnl4020_config *config = NULL,
+                 TwoWire *theWire = &Wire, uint8_t addr = VCNL4020_I2C_ADDRESS);
+
+  // Whole-configuration Functions
+  static void getDefaultConfig(vcnl4020_config *config);
+  bool getConfig(vcnl4020_config *config);
+  bool applyConfig(const vcnl4020_config *config);
 
   // Command Register Functions
-  void setOnDemand(bool als, bool prox);
-  void enable(bool als, bool prox, bool selftimed);
+  bool setOnDemand(bool als, bool prox);
+  bool enable(bool als, bool prox, bool selftimed);
 
   // Product ID Revision Register Function
   uint8_t getProdRevision();
 
   // Proximity Measurement Rate Functions
-  void setProxRate(vcnl4020_proxrate rate);
+  bool setProxRate(vcnl4020_proxrate rate);
   vcnl4020_proxrate getProxRate();
-  void setProxFrequency(vcnl4020_proxfreq freq);
+  bool setProxFrequency(vcnl4020_proxfreq freq);
   vcnl4020_proxfreq getProxFrequency();
 
   // LED Current Setting for Proximity Mode Functions
-  void setProxLEDmA(uint8_t LEDmA);
+  bool setProxLEDmA(uint8_t LEDmA);
   uint8_t getProxLEDmA();
 
   // Ambient Light Parameter Register Functions
-  void setContinuousConversion(bool continuous);
-  void setAutoOffsetComp(bool autoOffset);
+  bool setContinuousConversion(bool continuous);
+  bool setAutoOffsetComp(bool autoOffset);
 
   // Ambient Light Result Register Function
   bool isAmbientReady();
+  bool isAmbientReady(bool *ready);
   uint16_t readAmbient();
-  void setAmbientRate(vcnl4020_ambientrate rate);
+  bool readAmbient(uint16_t *ambient);
+  bool setAmbientRate(vcnl4020_ambientrate rate);
   vcnl4020_ambientrate getAmbientRate();
-  void setAmbientAveraging(vcnl4020_averaging avg);
+  bool setAmbientAveraging(vcnl4020_averaging avg);
   vcnl4020_averaging getAmbientAveraging();
 
+  // Ambient Light Conversion Functions
+  float readLux();
+  bool readLux(float *lux);
+  uint32_t readMilliLux();
+  bool readMilliLux(uint32_t *milliLux);
+  static uint32_t countsToMilliLux(uint16_t counts);
+  static uint32_t countsToLuxQ16(uint16_t counts);
+  static void countsToMilliLux(const uint16_t *counts, uint32_t *milliLux,
+                               uint16_t len);
+  static void countsToMilliLux(const vcnl4020_timed_sample *samples,
+                               uint32_t *milliLux, uint16_t len);
+
   // Proximity Measurement Result Register Function
   uint16_t readProximity();
+  bool readProximity(uint16_t *proximity);
   bool isProxReady();
+  bool isProxReady(bool *ready);
+  void setProxFilter(Adafruit_VCNL4020_Filter *filter);
+
+  // Crosstalk compensation
+  void setProxCalibration(Adafruit_VCNL4020_Calibration *calibration);
+  uint16_t getProxOffset();
+  static uint16_t crc16(const uint8_t *data, uint16_t len);
+
+  // Combined Result Register Function
+  bool readSample(vcnl4020_sample *sample, bool withStatus = true);
+
+  // Measurement timing
+  uint32_t channelPeriodMicros(vcnl4020_channel channel);
+  static uint32_t ambientPeriodMicros(vcnl4020_ambientrate rate);
 
   // Low and High Threshold Functions
-  void setLowThreshold(uint16_t threshold);
+  bool setLowThreshold(uint16_t threshold);
   uint16_t getLowThreshold();
-  void setHighThreshold(uint16_t threshold);
+  bool setHighThreshold(uint16_t threshold);
   uint16_t getHighThreshold();
+  bool setThresholds(uint16_t low, uint16_t high);
 
   // Interrupt Control Register Function
-  void setInterruptConfig(bool proxReady, bool alsReady, bool thresh,
+  bool setInterruptConfig(bool proxReady, bool alsReady, bool thresh,
                           bool threshALS, vcnl4020_int_count intCount);
+  bool writeInterruptControl(uint8_t value);
+  uint8_t getInterruptControl();
   uint8_t getInterruptStatus();
-  void clearInterrupts(bool proxready, bool alsready, bool th_low,
+  bool getInterruptStatus(uint8_t *status);
+  bool clearInterrupts(bool proxready, bool alsready, bool th_low,
                        bool th_high);
+  bool clearInterruptMask(uint8_t mask);
+  uint8_t readAndClearInterrupts();
+  bool readAndClearInterrupts(uint8_t *status);
+
+  // Interrupt-driven sampling
+  void setInterruptPin(int8_t pin);
+  void handleInterrupt();
+  void handleInterrupt(uint32_t timestamp);
+  bool fetchInterruptSample(vcnl4020_timed_sample *sample);
+  /*!
+   * @brief  Deferred half of interrupt-driven sampling: call from loop() (or
+   * any context that may use I2C) after attaching handleInterrupt() to the INT
+   * pin. Fetches the sample the INT pin announced and pushes it into buffer.
+   * @param  buffer  The ring buffer to fill.
+   * @return True if a sample was fetched (it may still have been dropped if
+   * the buffer was full, see overflows()).
+   */
+  template <uint8_t CAPACITY>
+  bool serviceInterrupt(Adafruit_VCNL4020_SampleBuffer<CAPACITY> *buffer) {
+    vcnl4020_timed_sample sample;
+    if (!fetchInterruptSample(&sample))
+      return false;
+    buffer->push(sample);
+    return true;
+  }
+
+  uint32_t conversionMicros(bool als, bool prox);
+  static uint32_t proxPeriodMicros(vcnl4020_proxrate rate);
+
+  // Register shadow cache
+  bool syncRegisters();
+  void invalidateRegisters();
+
+  // Bus error handling
+  bool recover();
+  void setRetries(uint8_t reads, uint8_t writes);
+  uint32_t getBusErrors();
+
+  // Capture and replay
+  void setBusTap(vcnl4020_bus_tap tap);
+  void setBusReplay(vcnl4020_bus_replay replay);
+  void setClock(vcnl4020_clock clock);
+  uint32_t now();
+
+#ifdef VCNL4020_ENABLE_STATS
+  // Bus statistics
+  vcnl4020_stats getStats(vcnl4020_stat_op op = VCNL4020_OP_TOTAL);
+  void resetStats();
+#endif
 
 private:
+  // Optional features keep their own state and share the bus helpers
+  friend class Adafruit_VCNL4020_Calibration;
+  friend class Adafruit_VCNL4020_Measurement;
+  friend class Adafruit_VCNL4020_ProxStream;
+  friend class Adafruit_VCNL4020_Recorder;
+  friend class Adafruit_VCNL4020_Tracker;
+
   Adafruit_I2CDevice *_i2c = NULL;
+
+  uint8_t _shadow[VCNL4020_REG_COUNT]; ///< Copy of registers 0x80 - 0x8F
+  bool _shadowValid = false;           ///< True once _shadow holds the chip
+  uint8_t _known[VCNL4020_REG_COUNT];  ///< Registers as last set by us
+  bool _knownValid = false;            ///< True once begin() filled _known
+
+  uint8_t _readRetries = 1;  ///< Retries per failed register read
+  uint8_t _writeRetries = 1; ///< Retries per failed register write
+  uint32_t _busErrors = 0;   ///< Transactions that failed after retries
+
+  vcnl4020_bus_tap _busTap = NULL;       ///< Sees every transaction, or NULL
+  vcnl4020_bus_replay _busReplay = NULL; ///< Replaces the chip, or NULL
+  vcnl4020_clock _clock = NULL;          ///< Time source, NULL for micros()
+
+  int8_t _intPin = -1;               ///< INT pin, or -1 if not known
+  volatile bool _intPending = false; ///< Set by handleInterrupt()
+  volatile uint32_t _intMicros = 0;  ///< micros() at the last INT edge
+
+  Adafruit_VCNL4020_Filter *_proxFilter = NULL; ///< Proximity filter stage
+
+  Adafruit_VCNL4020_Calibration *_calibration = NULL; ///< Offsets, or NULL
+  uint16_t _proxOffset = 0; ///< Offset of the current setting
+
+  bool init(const vcnl4020_config *config, TwoWire *theWire, uint8_t addr,
+            bool probe);
+  bool refreshRegisters();
+  uint8_t cachedRegister(uint8_t reg);
+  bool writeRegister(uint8_t reg, uint8_t value);
+  bool writeRegisters(uint8_t reg, const uint8_t *buffer, uint8_t len);
+  bool writeMasked(uint8_t reg, uint8_t mask, uint8_t bits);
+
+  /*!
+   * @brief  Writes one field from the shadow cache, without a read-back.
+   * @tparam FIELD  The Adafruit_VCNL4020_Field to write.
+   * @param  value  The new field value.
+   * @return True if the write was acknowledged, otherwise false.
+   */
+  template <class FIELD> bool writeField(uint8_t value) {
+    return writeMasked(FIELD::reg, FIELD::mask, FIELD::put(value));
+  }
+
+  /*!
+   * @brief  Reads one field from the shadow cache.
+   * @tparam FIELD  The Adafruit_VCNL4020_Field to read.
+   * @return The field value.
+   */
+  template <class FIELD> uint8_t readField() {
+    return FIELD::get(cachedRegister(FIELD::reg));
+  }
+  static bool isConfigRegister(uint8_t index);
+  static bool needsPause(uint8_t index);
+  bool writeDifferences(const uint8_t *target);
+  void updateProxOffset();
+  uint16_t compensate(uint16_t raw);
+  bool busRead(uint8_t reg, uint8_t *buffer, uint8_t len);
+  bool busWrite(uint8_t reg, const uint8_t *buffer, uint8_t len);
+  bool transfer(uint8_t reg, const uint8_t *out, uint8_t *in, uint8_t len);
+  void tapInterrupt(uint32_t timestamp);
+
+#ifdef VCNL4020_ENABLE_STATS
+  /*!
+   * @brief Attributes bus traffic to one group of driver calls while in scope
+   */
+  class StatsScope {
+  public:
+    StatsScope(Adafruit_VCNL4020 *dev, vcnl4020_stat_op op);
+    ~StatsScope();
+
+  private:
+    Adafruit_VCNL4020 *_dev; ///< The driver being measured
+    bool _outer;             ///< True if this is the outermost driver call
+  };
+
+  vcnl4020_stats _stats[VCNL4020_OP_TOTAL] = {}; ///< Per call group counters
+  vcnl4020_stat_op _statsOp = VCNL4020_OP_OTHER; ///< Group being measured
+  bool _statsBusy = false; ///< True while inside a measured driver call
+
+  void countTransaction(bool write, uint8_t bytes, uint32_t elapsed);
+#endif
 };
 
+#ifdef VCNL4020_ENABLE_STATS
+/// Attributes bus traffic of sensor until the end of the enclosing block to op
+#define VCNL4020_SENSOR_STATS_SCOPE(sensor, op)                                \
+  Adafruit_VCNL4020::StatsScope statsScope(sensor, op)
+#else
+#define VCNL4020_SENSOR_STATS_SCOPE(sensor, op)
+#endif
+
 #endif // ADAFRUIT_VCNL4020_H
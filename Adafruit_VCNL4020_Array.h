@@ -0,0 +1,174 @@
+/*!
+ * @file Adafruit_VCNL4020_Array.h
+ *
+ * Several VCNL4020 sensors behind a TCA9548A-style I2C multiplexer. The
+ * VCNL4020 address is fixed, so each sensor sits on its own mux channel.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef ADAFRUIT_VCNL4020_ARRAY_H
+#define ADAFRUIT_VCNL4020_ARRAY_H
+
+#include "Adafruit_VCNL4020.h"
+
+#define VCNL4020_MUX_I2C_ADDRESS 0x70 ///< Default TCA9548A address
+
+/** One sensor's part of a frame returned by readFrame() */
+typedef struct {
+  uint16_t proximity; ///< Proximity result
+  uint16_t ambient;   ///< Ambient light result
+  uint32_t timestamp; ///< micros() right after this sensor was read
+  bool valid;         ///< False if the sensor did not answer
+} vcnl4020_array_reading;
+
+/*!
+ * @brief Owns up to eight Adafruit_VCNL4020 instances on the channels of one
+ * I2C multiplexer. Sensors are read in channel order and a channel is only
+ * selected when it differs from the one already selected, so a frame costs
+ * one mux write plus one result burst per sensor.
+ * @tparam N Number of sensors, 1 - 8.
+ */
+template <uint8_t N> class Adafruit_VCNL4020_Array {
+public:
+  /*!
+   * @brief  Sets up the sensor array, call begin() before use.
+   * @param  muxAddr  The I2C address of the multiplexer.
+   */
+  Adafruit_VCNL4020_Array(uint8_t muxAddr = VCNL4020_MUX_I2C_ADDRESS) {
+    _muxAddr = muxAddr;
+  }
+
+  /*!
+   * @brief  Frees the multiplexer device.
+   */
+  ~Adafruit_VCNL4020_Array() {
+    if (_mux)
+      delete _mux;
+  }
+
+  /*!
+   * @brief  Initializes the multiplexer and every sensor.
+   * @param  channels  The mux channel (0 - 7) of each sensor, N entries. The
+   * index into this array is the sensor index used everywhere else.
+   * @param  theWire   The I2C interface the multiplexer is on.
+   * @param  config    Configuration for every sensor, or NULL for the
+   * begin() defaults.
+   * @return True if the multiplexer and all sensors were found.
+   */
+  bool begin(const uint8_t *channels, TwoWire *theWire = &Wire,
+             const vcnl4020_config *config = NULL) {
+    if (_mux)
+      delete _mux;
+    _mux = new Adafruit_I2CDevice(_muxAddr, theWire);
+    if (!_mux->begin())
+      return false;
+    _current = 0xFF;
+
+    // Sort the sensors by channel so a frame walks the mux in order
+    for (uint8_t i = 0; i < N; i++) {
+      _channels[i] = channels[i] & 0x07;
+      _order[i] = i;
+    }
+    for (uint8_t i = 1; i < N; i++) {
+      uint8_t sensor = _order[i];
+      uint8_t j = i;
+      while (j > 0 && _channels[_order[j - 1]] > _channels[sensor]) {
+        _order[j] = _order[j - 1];
+        j--;
+      }
+      _order[j] = sensor;
+    }
+
+    bool ok = true;
+    for (uint8_t i = 0; i < N; i++) {
+      uint8_t sensor = _order[i];
+      if (!selectChannel(_channels[sensor])) {
+        ok = false;
+        continue;
+      }
+      bool found = config ? _sensors[sensor].begin(config, theWire)
+                          : _sensors[sensor].begin(theWire);
+      ok = ok && found;
+    }
+    return ok;
+  }
+
+  /*!
+   * @brief  Reads proximity and ambient from every sensor. The walk starts at
+   * whichever sensor is on the channel left selected by the previous call, so
+   * back-to-back frames skip one mux switch.
+   * @param  frame  N readings, indexed like the channels passed to begin().
+   * @return True if every sensor was read.
+   */
+  bool readFrame(vcnl4020_array_reading *frame) {
+    uint8_t start = 0;
+    for (uint8_t i = 0; i < N; i++) {
+      if (_channels[_order[i]] == _current)
+        start = i;
+    }
+
+    bool ok = true;
+    for (uint8_t i = 0; i < N; i++) {
+      uint8_t sensor = _order[(start + i) % N];
+      vcnl4020_array_reading *reading = &frame[sensor];
+      vcnl4020_sample sample;
+
+      reading->valid = selectChannel(_channels[sensor]) &&
+                       _sensors[sensor].readSample(&sample, false);
+      reading->timestamp = _sensors[sensor].now();
+      if (reading->valid) {
+        reading->proximity = sample.proximity;
+        reading->ambient = sample.ambient;
+      }
+      ok = ok && reading->valid;
+    }
+    return ok;
+  }
+
+  /*!
+   * @brief  Selects a mux channel, skipping the write if it already is.
+   * Call this before using sensor() directly.
+   * @param  channel  The channel, 0 - 7.
+   * @return True if the channel is selected.
+   */
+  bool selectChannel(uint8_t channel) {
+    if (channel == _current)
+      return true;
+    uint8_t mask = 1 << channel;
+    if (!_mux->write(&mask, 1)) {
+      _current = 0xFF;
+      return false;
+    }
+    _current = channel;
+    return true;
+  }
+
+  /*!
+   * @brief  Gives access to one sensor, e.g. to change its configuration.
+   * Select its channel with selectChannel() first.
+   * @param  index  The sensor index, 0 - N-1.
+   * @return The driver instance.
+   */
+  Adafruit_VCNL4020 *sensor(uint8_t index) { return &_sensors[index]; }
+
+  /*!
+   * @brief  Gets the mux channel of a sensor.
+   * @param  index  The sensor index, 0 - N-1.
+   * @return The channel, 0 - 7.
+   */
+  uint8_t channel(uint8_t index) { return _channels[index]; }
+
+private:
+  static_assert(N >= 1 && N <= 8, "A TCA9548A has eight channels");
+
+  Adafruit_VCNL4020 _sensors[N];   ///< One driver per sensor
+  uint8_t _channels[N];            ///< Mux channel of each sensor
+  uint8_t _order[N];               ///< Sensor indexes sorted by channel
+  Adafruit_I2CDevice *_mux = NULL; ///< The multiplexer
+  uint8_t _muxAddr;                ///< I2C address of the multiplexer
+  uint8_t _current = 0xFF;         ///< Selected channel, 0xFF if unknown
+};
+
+#endif // ADAFRUIT_VCNL4020_ARRAY_H
@@ -0,0 +1,239 @@
+/*!
+ * @file Adafruit_VCNL4020_Calibration.cpp
+ *
+ * Optional crosstalk calibration for the VCNL4020.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Calibration.h"
+
+/*!
+ * @brief  Constructs an empty calibration for a sensor.
+ * @param  sensor  The sensor. Only calibrate() needs it initialized with
+ * begin().
+ */
+Adafruit_VCNL4020_Calibration::Adafruit_VCNL4020_Calibration(
+    Adafruit_VCNL4020 *sensor) {
+  _sensor = sensor;
+  _count = 0;
+  memset(_entries, 0, sizeof(_entries));
+}
+
+/*!
+ * @brief  Measures the crosstalk offset (cover glass reflection and ambient IR)
+ * at the current LED current and proximity frequency, and from then on has
+ * the sensor subtract it from every proximity result read at that setting.
+ * Nothing may be in front of the sensor. Blocks for about samples
+ * milliseconds and restores the configuration afterwards.
+ * @param  samples  How many on-demand measurements to average.
+ * @return True if the offset was measured and stored.
+ */
+bool Adafruit_VCNL4020_Calibration::calibrate(uint8_t samples) {
+  uint8_t ledmA = _sensor->getProxLEDmA();
+  return calibrate(&ledmA, 1, samples, _sensor->getProxFrequency(),
+                   _sensor->getProxFrequency());
+}
+
+/*!
+ * @brief  Measures the crosstalk offset for several LED currents, each at a
+ * range of proximity frequencies, so every setting the application (or
+ * Adafruit_VCNL4020_Governor) switches between is compensated. See
+ * calibrate(uint8_t) for the conditions.
+ * @param  ledmA    The LED currents in mA.
+ * @param  count    How many LED currents.
+ * @param  samples  How many on-demand measurements to average per setting.
+ * @param  first    The lowest proximity frequency to calibrate.
+ * @param  last     The highest proximity frequency to calibrate.
+ * @return True if all offsets were measured and stored. False on a bus error
+ * or if the calibration would need more than VCNL4020_CAL_MAX_ENTRIES
+ * settings; the current calibration is then kept as it was.
+ */
+bool Adafruit_VCNL4020_Calibration::calibrate(const uint8_t *ledmA,
+                                              uint8_t count, uint8_t samples,
+                                              vcnl4020_proxfreq first,
+                                              vcnl4020_proxfreq last) {
+  VCNL4020_SENSOR_STATS_SCOPE(_sensor, VCNL4020_OP_CALIBRATE);
+
+  // Check the sweep fits before measuring anything
+  uint16_t settings = last >= first ? count * (last - first + 1) : 0;
+  if (settings > VCNL4020_CAL_MAX_ENTRIES)
+    return false;
+  vcnl4020_cal_entry staged[VCNL4020_CAL_MAX_ENTRIES];
+  uint8_t staging = 0, added = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    for (uint8_t freq = first; freq <= last; freq++) {
+      uint8_t ledCode = ledmA[i] / 10;
+      bool known = findOffset(ledCode, freq) < _count;
+      for (uint8_t j = 0; j < staging; j++)
+        known |= staged[j].ledCode == ledCode && staged[j].frequency == freq;
+      added += !known;
+      staged[staging].ledCode = ledCode;
+      staged[staging++].frequency = freq;
+    }
+  }
+  if (_count + added > VCNL4020_CAL_MAX_ENTRIES)
+    return false;
+
+  vcnl4020_config saved;
+  if (!_sensor->getConfig(&saved))
+    return false;
+  if (samples == 0)
+    samples = 1;
+
+  // Self-timed measurements would race our on-demand ones
+  bool ok = _sensor->enable(false, false, false);
+  for (uint8_t i = 0; ok && i < staging; i++) {
+    ok = _sensor->setProxLEDmA(staged[i].ledCode * 10) &&
+         _sensor->setProxFrequency((vcnl4020_proxfreq)staged[i].frequency) &&
+         measureOffset(samples, &staged[i].offset);
+  }
+
+  // Only a complete sweep replaces offsets
+  if (ok) {
+    for (uint8_t i = 0; i < staging; i++)
+      storeOffset(staged[i].ledCode, staged[i].frequency, staged[i].offset);
+    _sensor->setProxCalibration(this);
+  }
+
+  ok = _sensor->applyConfig(&saved) && ok;
+  refresh();
+  return ok;
+}
+
+/*!
+ * @brief  Gets the calibration, with its version and CRC filled in, for the
+ * application to persist, e.g. in EEPROM.
+ * @param  cal  Where to store the calibration.
+ */
+void Adafruit_VCNL4020_Calibration::getCalibration(vcnl4020_calibration *cal) {
+  memset(cal, 0, sizeof(*cal));
+  cal->version = VCNL4020_CAL_VERSION;
+  cal->count = _count;
+  memcpy(cal->entries, _entries, sizeof(_entries));
+  cal->crc = Adafruit_VCNL4020::crc16((const uint8_t *)cal,
+                                      offsetof(vcnl4020_calibration, crc));
+}
+
+/*!
+ * @brief  Restores a calibration saved with getCalibration(), without
+ * measuring and without bus traffic, and sets it on the sensor. May be
+ * called before begin(), the sensor keeps it across begin() and fastBegin().
+ * @param  cal  The calibration.
+ * @return True if it was restored, false if its version or CRC is wrong (the
+ * current calibration is then kept).
+ */
+bool Adafruit_VCNL4020_Calibration::setCalibration(
+    const vcnl4020_calibration *cal) {
+  if (cal->version != VCNL4020_CAL_VERSION ||
+      cal->count > VCNL4020_CAL_MAX_ENTRIES ||
+      cal->crc != Adafruit_VCNL4020::crc16(
+                      (const uint8_t *)cal,
+                      offsetof(vcnl4020_calibration, crc)))
+    return false;
+
+  _count = cal->count;
+  memcpy(_entries, cal->entries, sizeof(_entries));
+  _sensor->setProxCalibration(this);
+  return true;
+}
+
+/*!
+ * @brief  Forgets all offsets, proximity results are reported raw again.
+ */
+void Adafruit_VCNL4020_Calibration::clear() {
+  _count = 0;
+  refresh();
+}
+
+/*!
+ * @brief  Gets the offset of one setting, as the sensor looks it up whenever
+ * its LED current or proximity frequency changes.
+ * @param  ledCode    The LED current in 10 mA units.
+ * @param  frequency  The proximity frequency.
+ * @return The offset in proximity counts, 0 if the setting is not calibrated.
+ */
+uint16_t Adafruit_VCNL4020_Calibration::getOffset(uint8_t ledCode,
+                                                  uint8_t frequency) {
+  uint8_t i = findOffset(ledCode, frequency);
+  return i < _count ? _entries[i].offset : 0;
+}
+
+/*!
+ * @brief  Averages on-demand proximity measurements at the current setting.
+ * Measurements must be disabled.
+ * @param  samples  How many measurements.
+ * @param  offset   Where to store the rounded mean.
+ * @return True if every measurement was read.
+ */
+bool Adafruit_VCNL4020_Calibration::measureOffset(uint8_t samples,
+                                                  uint16_t *offset) {
+  uint32_t sum = 0;
+  for (uint8_t i = 0; i < samples; i++) {
+    if (!_sensor->setOnDemand(false, true))
+      return false;
+
+    // A proximity conversion is well under 1 ms, give up after 10
+    uint32_t start = _sensor->now();
+    uint8_t command = 0;
+    while (!vcnl4020_prox_data_rdy_field::get(command)) {
+      if (_sensor->now() - start > 10000 ||
+          !_sensor->busRead(VCNL4020_REG_COMMAND, &command, 1))
+        return false;
+    }
+
+    uint8_t buffer[2];
+    if (!_sensor->busRead(VCNL4020_REG_PROX_RESULT_HIGH, buffer, 2))
+      return false;
+    sum += ((uint16_t)buffer[0] << 8) | buffer[1];
+  }
+  *offset = (sum + samples / 2) / samples;
+  return true;
+}
+
+/*!
+ * @brief  Finds the entry of one setting.
+ * @param  ledCode    The LED current in 10 mA units.
+ * @param  frequency  The proximity frequency.
+ * @return The index of the entry, or _count if the setting has none.
+ */
+uint8_t Adafruit_VCNL4020_Calibration::findOffset(uint8_t ledCode,
+                                                  uint8_t frequency) {
+  uint8_t i = 0;
+  while (i < _count && (_entries[i].ledCode != ledCode ||
+                        _entries[i].frequency != frequency))
+    i++;
+  return i;
+}
+
+/*!
+ * @brief  Adds or replaces the entry of one setting.
+ * @param  ledCode    The LED current in 10 mA units.
+ * @param  frequency  The proximity frequency.
+ * @param  offset     The measured offset.
+ * @return True if stored, false if the table is full.
+ */
+bool Adafruit_VCNL4020_Calibration::storeOffset(uint8_t ledCode,
+                                                uint8_t frequency,
+                                                uint16_t offset) {
+  uint8_t i = findOffset(ledCode, frequency);
+  if (i == VCNL4020_CAL_MAX_ENTRIES)
+    return false;
+  if (i == _count)
+    _count++;
+
+  _entries[i].ledCode = ledCode;
+  _entries[i].frequency = frequency;
+  _entries[i].offset = offset;
+  return true;
+}
+
+/*!
+ * @brief  Has the sensor look up its offset again, if this is its
+ * calibration.
+ */
+void Adafruit_VCNL4020_Calibration::refresh() {
+  if (_sensor->_calibration == this)
+    _sensor->setProxCalibration(this);
+}
@@ -0,0 +1,65 @@
+/*!
+ * @file Adafruit_VCNL4020_Calibration.h
+ *
+ * Optional crosstalk calibration for the VCNL4020: measures the proximity
+ * offset of the cover glass at each LED current and proximity frequency, and
+ * has the sensor subtract it from every proximity result.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef ADAFRUIT_VCNL4020_CALIBRATION_H
+#define ADAFRUIT_VCNL4020_CALIBRATION_H
+
+#include "Adafruit_VCNL4020.h"
+
+#define VCNL4020_CAL_VERSION 1     ///< Layout of vcnl4020_calibration
+#define VCNL4020_CAL_MAX_ENTRIES 8 ///< Settings one calibration can hold
+
+/** Crosstalk offset of one LED current and proximity frequency */
+typedef struct {
+  uint8_t ledCode;   ///< LED current in 10 mA units, as in register #3
+  uint8_t frequency; ///< vcnl4020_proxfreq
+  uint16_t offset;   ///< Mean proximity with nothing in front of the sensor
+} vcnl4020_cal_entry;
+
+/** Crosstalk calibration blob for the application to persist */
+typedef struct {
+  uint8_t version; ///< VCNL4020_CAL_VERSION
+  uint8_t count;   ///< Entries in use
+  vcnl4020_cal_entry entries[VCNL4020_CAL_MAX_ENTRIES]; ///< Offsets
+  uint16_t crc; ///< CRC-16 of everything above, see Adafruit_VCNL4020::crc16()
+} vcnl4020_calibration;
+
+/*!
+ * @brief Holds the crosstalk offsets of one sensor. Once it holds offsets,
+ * from calibrate() or setCalibration(), it sets itself as the sensor's
+ * calibration with Adafruit_VCNL4020::setProxCalibration(), and the sensor
+ * subtracts the offset of its current setting from every proximity result.
+ */
+class Adafruit_VCNL4020_Calibration {
+public:
+  Adafruit_VCNL4020_Calibration(Adafruit_VCNL4020 *sensor);
+
+  bool calibrate(uint8_t samples = 16);
+  bool calibrate(const uint8_t *ledmA, uint8_t count, uint8_t samples = 16,
+                 vcnl4020_proxfreq first = PROX_FREQ_390_625_KHZ,
+                 vcnl4020_proxfreq last = PROX_FREQ_3_125_MHZ);
+  void getCalibration(vcnl4020_calibration *cal);
+  bool setCalibration(const vcnl4020_calibration *cal);
+  void clear();
+  uint16_t getOffset(uint8_t ledCode, uint8_t frequency);
+
+private:
+  Adafruit_VCNL4020 *_sensor; ///< The sensor being calibrated
+  vcnl4020_cal_entry _entries[VCNL4020_CAL_MAX_ENTRIES]; ///< Offsets
+  uint8_t _count; ///< Entries of _entries in use
+
+  bool measureOffset(uint8_t samples, uint16_t *offset);
+  uint8_t findOffset(uint8_t ledCode, uint8_t frequency);
+  bool storeOffset(uint8_t ledCode, uint8_t frequency, uint16_t offset);
+  void refresh();
+};
+
+#endif // ADAFRUIT_VCNL4020_CALIBRATION_H
@@ -0,0 +1,122 @@
+/*!
+ * @file Adafruit_VCNL4020_Filter.cpp
+ *
+ * Integer-only smoothing and decimation for VCNL4020 proximity samples.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Filter.h"
+
+/*!
+ * @brief  Constructs a filter, see configure() for the parameters.
+ * @param  type        The filter stage.
+ * @param  length      Window length for boxcar and median, or the EMA shift.
+ * @param  decimation  Produce one output per this many samples.
+ */
+Adafruit_VCNL4020_Filter::Adafruit_VCNL4020_Filter(vcnl4020_filter_type type,
+                                                   uint8_t length,
+                                                   uint8_t decimation) {
+  configure(type, length, decimation);
+}
+
+/*!
+ * @brief  Changes the filter stage and clears its history.
+ * @param  type        The filter stage.
+ * @param  length      For VCNL4020_FILTER_BOXCAR and VCNL4020_FILTER_MEDIAN the
+ * number of samples in the window, 1 - VCNL4020_FILTER_MAX_LENGTH. For
+ * VCNL4020_FILTER_EMA the smoothing shift, 1 - 15, where each output moves
+ * 1/2^length of the way towards the new sample.
+ * @param  decimation  Produce one output per this many samples, at least 1.
+ */
+void Adafruit_VCNL4020_Filter::configure(vcnl4020_filter_type type,
+                                         uint8_t length, uint8_t decimation) {
+  uint8_t longest = (type == VCNL4020_FILTER_EMA) ? 15
+                                                  : VCNL4020_FILTER_MAX_LENGTH;
+  _type = type;
+  _length = length < 1 ? 1 : (length > longest ? longest : length);
+  _decimation = decimation < 1 ? 1 : decimation;
+  reset();
+}
+
+/*!
+ * @brief  Forgets all samples, the next one starts the filter afresh.
+ */
+void Adafruit_VCNL4020_Filter::reset() {
+  _phase = 0;
+  _count = 0;
+  _head = 0;
+  _state = 0;
+  _output = 0;
+}
+
+/*!
+ * @brief  Feeds one raw sample through the filter.
+ * @param  sample  The raw proximity sample.
+ * @return True if this sample completes a decimation period, so output()
+ * holds a new value to pass on.
+ */
+bool Adafruit_VCNL4020_Filter::push(uint16_t sample) {
+  switch (_type) {
+  case VCNL4020_FILTER_NONE:
+    _output = sample;
+    break;
+
+  case VCNL4020_FILTER_EMA:
+    // _state holds the average scaled up by 2^_length
+    if (_count == 0) {
+      _state = (uint32_t)sample << _length;
+      _count = 1;
+    } else {
+      _state = _state - (_state >> _length) + sample;
+    }
+    _output = _state >> _length;
+    break;
+
+  case VCNL4020_FILTER_BOXCAR:
+  case VCNL4020_FILTER_MEDIAN:
+    if (_count == _length)
+      _state -= _window[_head];
+    else
+      _count++;
+    _window[_head] = sample;
+    _state += sample;
+    _head = (_head + 1 == _length) ? 0 : _head + 1;
+
+    if (_type == VCNL4020_FILTER_BOXCAR)
+      _output = (_state + _count / 2) / _count;
+    else
+      _output = median();
+    break;
+  }
+
+  if (++_phase < _decimation)
+    return false;
+  _phase = 0;
+  return true;
+}
+
+/*!
+ * @brief  Gets the latest filter output.
+ * @return The filtered proximity value.
+ */
+uint16_t Adafruit_VCNL4020_Filter::output() { return _output; }
+
+/*!
+ * @brief  Median of the samples in the window, by insertion sort of a copy.
+ * @return The middle value, the upper one of the two for even counts.
+ */
+uint16_t Adafruit_VCNL4020_Filter::median() {
+  uint16_t sorted[VCNL4020_FILTER_MAX_LENGTH];
+  for (uint8_t i = 0; i < _count; i++) {
+    uint16_t value = _window[i];
+    uint8_t j = i;
+    while (j > 0 && sorted[j - 1] > value) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = value;
+  }
+  return sorted[_count / 2];
+}
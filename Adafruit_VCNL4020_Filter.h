@@ -0,0 +1,56 @@
+/*!
+ * @file Adafruit_VCNL4020_Filter.h
+ *
+ * Integer-only smoothing and decimation for VCNL4020 proximity samples, so
+ * no float math is needed on small MCUs. Plugs in behind readProximity() and
+ * Adafruit_VCNL4020_ProxStream with Adafruit_VCNL4020::setProxFilter().
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef ADAFRUIT_VCNL4020_FILTER_H
+#define ADAFRUIT_VCNL4020_FILTER_H
+
+#include "Arduino.h"
+
+#define VCNL4020_FILTER_MAX_LENGTH 16 ///< Longest boxcar or median window
+
+/** The filter stage to run on each proximity sample */
+typedef enum {
+  VCNL4020_FILTER_NONE,   ///< Pass samples through (decimation still applies)
+  VCNL4020_FILTER_BOXCAR, ///< Mean of the last length samples
+  VCNL4020_FILTER_EMA,    ///< Exponential moving average, alpha = 1/2^length
+  VCNL4020_FILTER_MEDIAN  ///< Median of the last length samples, kills spikes
+} vcnl4020_filter_type;
+
+/*!
+ * @brief Fixed-size integer filter with decimation. State is a few bytes plus
+ * a VCNL4020_FILTER_MAX_LENGTH sample window, no heap.
+ */
+class Adafruit_VCNL4020_Filter {
+public:
+  Adafruit_VCNL4020_Filter(vcnl4020_filter_type type = VCNL4020_FILTER_NONE,
+                           uint8_t length = 4, uint8_t decimation = 1);
+
+  void configure(vcnl4020_filter_type type, uint8_t length,
+                 uint8_t decimation = 1);
+  void reset();
+  bool push(uint16_t sample);
+  uint16_t output();
+
+private:
+  vcnl4020_filter_type _type; ///< Which filter stage runs
+  uint8_t _length;            ///< Window length, or EMA shift
+  uint8_t _decimation;        ///< Produce one output per this many samples
+  uint8_t _phase;             ///< Samples since the last output
+  uint8_t _count;             ///< Samples in the window, up to _length
+  uint8_t _head;              ///< Next window slot to overwrite
+  uint32_t _state;            ///< Boxcar sum or EMA accumulator
+  uint16_t _output;           ///< Latest filter output
+  uint16_t _window[VCNL4020_FILTER_MAX_LENGTH]; ///< Last _length samples
+
+  uint16_t median();
+};
+
+#endif // ADAFRUIT_VCNL4020_FILTER_H
@@ -0,0 +1,148 @@
+/*!
+ * @file Adafruit_VCNL4020_Governor.cpp
+ *
+ * Optional power governor for the VCNL4020 proximity LED and rate.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Governor.h"
+
+/*!
+ * @brief  Constructs a governor for a sensor, call begin() to start it.
+ * @param  sensor  The sensor, already initialized with begin().
+ */
+Adafruit_VCNL4020_Governor::Adafruit_VCNL4020_Governor(
+    Adafruit_VCNL4020 *sensor) {
+  _sensor = sensor;
+  _levels = 0;
+  memset(&_state, 0, sizeof(_state));
+  getDefaultPolicy(&_policy);
+}
+
+/*!
+ * @brief  Fills in a policy that matches the begin() defaults when active and
+ * drops to 50 mA at 7.8 measurements/s after a few quiet seconds.
+ * @param  policy  The policy to fill in.
+ */
+void Adafruit_VCNL4020_Governor::getDefaultPolicy(
+    vcnl4020_governor_policy *policy) {
+  policy->activeLEDmA = 200;
+  policy->activeRate = PROX_RATE_250_PER_S;
+  policy->idleLEDmA = 50;
+  policy->idleRate = PROX_RATE_7_8_PER_S;
+  policy->wakeThreshold = 3000;
+  policy->idleThreshold = 2600;
+  policy->stepMillis = 1000;
+  policy->useThresholdInterrupt = false;
+}
+
+/*!
+ * @brief  Starts governing at the active level. Remembers the application's
+ * interrupt settings so they can be restored on waking.
+ * @param  policy  The tuning to use.
+ * @return True if the active settings were written.
+ */
+bool Adafruit_VCNL4020_Governor::begin(const vcnl4020_governor_policy *policy) {
+  _policy = *policy;
+  _levels = (_policy.activeRate > _policy.idleRate)
+                ? _policy.activeRate - _policy.idleRate
+                : 1;
+
+  _intControl = _sensor->getInterruptControl();
+  _lowThreshold = _sensor->getLowThreshold();
+  _highThreshold = _sensor->getHighThreshold();
+
+  _state.level = 0xFF; // force a write
+  _state.quietSince = _sensor->now();
+  return setLevel(0);
+}
+
+/*!
+ * @brief  Feeds one proximity sample to the governor, which may change the
+ * LED current and rate in response.
+ * @param  proximity  A proximity reading taken at the current level.
+ * @return True if the settings were changed.
+ */
+bool Adafruit_VCNL4020_Governor::update(uint16_t proximity) {
+  // Scale to what the reading would be at the active LED current
+  uint32_t scaled = (uint32_t)proximity * _policy.activeLEDmA;
+  uint32_t ledmA = _state.ledmA ? _state.ledmA : 1;
+  uint32_t now = _sensor->now();
+
+  if (scaled >= (uint32_t)_policy.wakeThreshold * ledmA) {
+    _state.quietSince = now;
+    return (_state.level != 0) && setLevel(0);
+  }
+
+  if (scaled >= (uint32_t)_policy.idleThreshold * ledmA) {
+    // In the hysteresis band, hold the current level
+    _state.quietSince = now;
+    return false;
+  }
+
+  if (_state.level < _levels &&
+      now - _state.quietSince >= (uint32_t)_policy.stepMillis * 1000) {
+    _state.quietSince = now;
+    return setLevel(_state.level + 1);
+  }
+  return false;
+}
+
+/*!
+ * @brief  Gets the current level, LED current, rate and quiet timer.
+ * @param  state  The state to fill in.
+ */
+void Adafruit_VCNL4020_Governor::getState(vcnl4020_governor_state *state) {
+  *state = _state;
+}
+
+/*!
+ * @brief  Gets the number of steps between fully active and fully idle.
+ * @return The highest level.
+ */
+uint8_t Adafruit_VCNL4020_Governor::levels() { return _levels; }
+
+/*!
+ * @brief  Programs the LED current, rate and wake threshold of a level in one
+ * applyConfig() pass, so only the registers that change are written.
+ * @param  level  0 for fully active up to levels() for fully idle.
+ * @return True if the settings were written.
+ */
+bool Adafruit_VCNL4020_Governor::setLevel(uint8_t level) {
+  vcnl4020_config config;
+  if (!_sensor->getConfig(&config))
+    return false;
+
+  // Step the rate one notch per level, interpolate the LED current
+  uint8_t span = (_policy.activeLEDmA > _policy.idleLEDmA)
+                     ? _policy.activeLEDmA - _policy.idleLEDmA
+                     : 0;
+  config.proxLEDmA = _policy.activeLEDmA - (uint16_t)span * level / _levels;
+  config.proxRate = (vcnl4020_proxrate)max(
+      (int)_policy.activeRate - (int)level, (int)_policy.idleRate);
+
+  if (level != 0 && _policy.useThresholdInterrupt) {
+    // Let the chip wake us: threshold INT on proximity, scaled to this level.
+    // Ready interrupts would fire every conversion, so they are off while idle
+    uint8_t count = vcnl4020_int_count_field::get(_intControl);
+    config.interruptControl = vcnl4020_int_count_field::put(count) |
+                              vcnl4020_int_thresh_en_field::put(true);
+    config.lowThreshold = 0;
+    config.highThreshold = (uint32_t)_policy.wakeThreshold *
+                           config.proxLEDmA / _policy.activeLEDmA;
+  } else {
+    config.interruptControl = _intControl;
+    config.lowThreshold = _lowThreshold;
+    config.highThreshold = _highThreshold;
+  }
+
+  if (!_sensor->applyConfig(&config))
+    return false;
+
+  _state.level = level;
+  _state.ledmA = _sensor->getProxLEDmA();
+  _state.rate = config.proxRate;
+  return true;
+}
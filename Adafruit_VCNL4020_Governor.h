@@ -0,0 +1,66 @@
+/*!
+ * @file Adafruit_VCNL4020_Governor.h
+ *
+ * Optional power governor for the VCNL4020: steps the proximity LED current
+ * and measurement rate down while nothing is near, and back up as soon as
+ * something approaches.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef ADAFRUIT_VCNL4020_GOVERNOR_H
+#define ADAFRUIT_VCNL4020_GOVERNOR_H
+
+#include "Adafruit_VCNL4020.h"
+
+/** Tuning for Adafruit_VCNL4020_Governor */
+typedef struct {
+  uint8_t activeLEDmA;          ///< LED current while something is near
+  vcnl4020_proxrate activeRate; ///< Proximity rate while something is near
+  uint8_t idleLEDmA;            ///< Lowest LED current when idle
+  vcnl4020_proxrate idleRate;   ///< Lowest proximity rate when idle
+  uint16_t wakeThreshold;       ///< Proximity at active current to wake at
+  uint16_t idleThreshold;       ///< Proximity at active current to idle below
+  uint16_t stepMillis;          ///< Quiet time before each step down
+  bool useThresholdInterrupt;   ///< Fire INT on wakeThreshold while idle
+} vcnl4020_governor_policy;
+
+/** What the governor is currently doing */
+typedef struct {
+  uint8_t level;          ///< 0 when fully active, levels() when fully idle
+  uint8_t ledmA;          ///< LED current of this level
+  vcnl4020_proxrate rate; ///< Proximity rate of this level
+  uint32_t quietSince;    ///< Sensor now() when proximity dropped below idle
+} vcnl4020_governor_state;
+
+/*!
+ * @brief Watches proximity samples and trades power for latency. Readings are
+ * compared after scaling to the active LED current, so one pair of thresholds
+ * works at every level. Stepping down happens one level per stepMillis of
+ * quiet; waking jumps straight back to the active level on the first sample
+ * above wakeThreshold.
+ */
+class Adafruit_VCNL4020_Governor {
+public:
+  Adafruit_VCNL4020_Governor(Adafruit_VCNL4020 *sensor);
+
+  static void getDefaultPolicy(vcnl4020_governor_policy *policy);
+  bool begin(const vcnl4020_governor_policy *policy);
+  bool update(uint16_t proximity);
+  void getState(vcnl4020_governor_state *state);
+  uint8_t levels();
+
+private:
+  Adafruit_VCNL4020 *_sensor;       ///< The sensor being governed
+  vcnl4020_governor_policy _policy; ///< Tuning
+  vcnl4020_governor_state _state;   ///< Current level and quiet timer
+  uint8_t _levels;                  ///< Number of steps down from active
+  uint8_t _intControl;              ///< Application's INT control register
+  uint16_t _lowThreshold;           ///< Application's low threshold
+  uint16_t _highThreshold;          ///< Application's high threshold
+
+  bool setLevel(uint8_t level);
+};
+
+#endif // ADAFRUIT_VCNL4020_GOVERNOR_H
@@ -0,0 +1,133 @@
+/*!
+ * @file Adafruit_VCNL4020_Measurement.cpp
+ *
+ * Optional asynchronous on-demand measurement for the VCNL4020.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Measurement.h"
+
+/*!
+ * @brief  Constructs an idle measurement for a sensor.
+ * @param  sensor  The sensor, already initialized with begin().
+ */
+Adafruit_VCNL4020_Measurement::Adafruit_VCNL4020_Measurement(
+    Adafruit_VCNL4020 *sensor) {
+  _sensor = sensor;
+  _state = VCNL4020_MEAS_IDLE;
+  _callback = NULL;
+  _pending = 0;
+  _start = 0;
+  _next = 0;
+  _expect = 0;
+  memset(&_result, 0, sizeof(_result));
+}
+
+/*!
+ * @brief  Starts an on-demand measurement without waiting for it. Drive it
+ * with poll() from loop(), which only checks the chip once the conversion
+ * should be done. Self-timed mode should be disabled first.
+ * @param  als   True to measure ambient light.
+ * @param  prox  True to measure proximity.
+ * @return True if the measurement was started, false if nothing was asked
+ * for or the write failed.
+ */
+bool Adafruit_VCNL4020_Measurement::request(bool als, bool prox) {
+  VCNL4020_SENSOR_STATS_SCOPE(_sensor, VCNL4020_OP_MEASUREMENT);
+
+  if (!als && !prox)
+    return false;
+
+  _pending = vcnl4020_als_data_rdy_field::put(als) |
+             vcnl4020_prox_data_rdy_field::put(prox);
+  _expect = _sensor->conversionMicros(als, prox);
+  _next = _expect;
+  memset(&_result, 0, sizeof(_result));
+
+  if (!_sensor->setOnDemand(als, prox)) {
+    _state = VCNL4020_MEAS_IDLE;
+    return false;
+  }
+  _start = _sensor->now();
+  _state = VCNL4020_MEAS_BUSY;
+  return true;
+}
+
+/*!
+ * @brief  Advances the measurement started by request(). Never blocks:
+ * returns straight away until the expected conversion time has passed, then
+ * checks the ready flags and results in one burst, rechecking every quarter
+ * of the expected time. Gives up after four times the expected time. Calls
+ * the callback, if any, on completion.
+ * @return The state of the measurement.
+ */
+vcnl4020_meas_state Adafruit_VCNL4020_Measurement::poll() {
+  VCNL4020_SENSOR_STATS_SCOPE(_sensor, VCNL4020_OP_MEASUREMENT);
+
+  if (_state != VCNL4020_MEAS_BUSY)
+    return _state;
+
+  uint32_t elapsed = _sensor->now() - _start;
+  if (elapsed < _next)
+    return _state;
+
+  vcnl4020_sample sample;
+  if (_sensor->readSample(&sample)) {
+    if ((_pending & vcnl4020_als_data_rdy_field::mask) &&
+        sample.ambientReady) {
+      _result.ambient = sample.ambient;
+      _result.ambientReady = true;
+      _pending &= ~vcnl4020_als_data_rdy_field::mask;
+    }
+    if ((_pending & vcnl4020_prox_data_rdy_field::mask) && sample.proxReady) {
+      _result.proximity = sample.proximity;
+      _result.proxReady = true;
+      _pending &= ~vcnl4020_prox_data_rdy_field::mask;
+    }
+  }
+
+  if (_pending == 0) {
+    _state = VCNL4020_MEAS_DONE;
+    if (_callback)
+      _callback(&_result);
+  } else if (elapsed > 4 * _expect) {
+    _state = VCNL4020_MEAS_TIMEOUT;
+  } else {
+    _next = elapsed + max(_expect / 4, (uint32_t)500);
+  }
+  return _state;
+}
+
+/*!
+ * @brief  Checks if the requested measurement is done. Does not touch the
+ * bus, call poll() to make progress.
+ * @return True if result() has the requested values.
+ */
+bool Adafruit_VCNL4020_Measurement::isComplete() {
+  return _state == VCNL4020_MEAS_DONE;
+}
+
+/*!
+ * @brief  Gets the results of a completed measurement. The ready flags tell
+ * which of the values were measured.
+ * @param  sample  Where to store the results.
+ * @return True if the measurement completed.
+ */
+bool Adafruit_VCNL4020_Measurement::result(vcnl4020_sample *sample) {
+  if (_state != VCNL4020_MEAS_DONE)
+    return false;
+  *sample = _result;
+  return true;
+}
+
+/*!
+ * @brief  Sets a function for poll() to call when a requested measurement
+ * completes.
+ * @param  callback  The function, or NULL for none.
+ */
+void Adafruit_VCNL4020_Measurement::setCallback(
+    vcnl4020_meas_callback callback) {
+  _callback = callback;
+}
@@ -0,0 +1,55 @@
+/*!
+ * @file Adafruit_VCNL4020_Measurement.h
+ *
+ * Optional asynchronous on-demand measurement for the VCNL4020: starts a
+ * conversion and lets loop() carry on until the results are in, instead of
+ * busy-waiting on the ready flags.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef ADAFRUIT_VCNL4020_MEASUREMENT_H
+#define ADAFRUIT_VCNL4020_MEASUREMENT_H
+
+#include "Adafruit_VCNL4020.h"
+
+/** Progress of an asynchronous on-demand measurement */
+typedef enum {
+  VCNL4020_MEAS_IDLE,    ///< No measurement requested
+  VCNL4020_MEAS_BUSY,    ///< Conversion in progress
+  VCNL4020_MEAS_DONE,    ///< Results available from result()
+  VCNL4020_MEAS_TIMEOUT  ///< The chip never reported the results ready
+} vcnl4020_meas_state;
+
+/** Called by poll() when a requested measurement completes */
+typedef void (*vcnl4020_meas_callback)(const vcnl4020_sample *sample);
+
+/*!
+ * @brief Runs one on-demand measurement at a time without blocking. The chip
+ * is only checked once the conversion should be done, so polling from a busy
+ * loop costs no bus traffic while the conversion runs.
+ */
+class Adafruit_VCNL4020_Measurement {
+public:
+  Adafruit_VCNL4020_Measurement(Adafruit_VCNL4020 *sensor);
+
+  bool request(bool als, bool prox);
+  vcnl4020_meas_state poll();
+  bool isComplete();
+  bool result(vcnl4020_sample *sample);
+  void setCallback(vcnl4020_meas_callback callback);
+
+private:
+  Adafruit_VCNL4020 *_sensor;       ///< The sensor being measured
+  vcnl4020_meas_state _state;       ///< Measurement state
+  vcnl4020_sample _result;          ///< Results so far
+  vcnl4020_meas_callback _callback; ///< Completion callback, or NULL
+
+  uint8_t _pending; ///< *_data_rdy field bits still due
+  uint32_t _start;  ///< micros() when the measurement was requested
+  uint32_t _next;   ///< micros() offset of the next status check
+  uint32_t _expect; ///< Expected conversion time in us
+};
+
+#endif // ADAFRUIT_VCNL4020_MEASUREMENT_H
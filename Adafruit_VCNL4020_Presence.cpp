@@ -0,0 +1,152 @@
+/*!
+ * @file Adafruit_VCNL4020_Presence.cpp
+ *
+ * Integer-only presence and approach / retreat detection on VCNL4020
+ * proximity samples.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Presence.h"
+
+#define VCNL4020_PRESENCE_HALF (VCNL4020_PRESENCE_WINDOW / 2) ///< Per half
+#define VCNL4020_PRESENCE_MASK (VCNL4020_PRESENCE_WINDOW - 1) ///< Ring wrap
+
+/*!
+ * @brief  Constructs an engine with the getDefaultConfig() tuning.
+ */
+Adafruit_VCNL4020_Presence::Adafruit_VCNL4020_Presence() {
+  getDefaultConfig(&_config);
+  reset();
+}
+
+/*!
+ * @brief  Fills in a tuning that matches the begin() defaults of 200 mA at
+ * 250 measurements/s: present above 3000 counts, gone below 2600, three
+ * samples in a row to change, approach / retreat at 50 counts per sample.
+ * @param  config  The tuning to fill in.
+ */
+void Adafruit_VCNL4020_Presence::getDefaultConfig(
+    vcnl4020_presence_config *config) {
+  config->enterLevel = 3000;
+  config->exitLevel = 2600;
+  config->dwell = 3;
+  config->approachRate = 50 * 16;
+}
+
+/*!
+ * @brief  Changes the tuning and starts over.
+ * @param  config  The tuning to use.
+ */
+void Adafruit_VCNL4020_Presence::begin(const vcnl4020_presence_config *config) {
+  _config = *config;
+  if (_config.dwell == 0)
+    _config.dwell = 1;
+  reset();
+}
+
+/*!
+ * @brief  Forgets all samples, the next one fills the whole window.
+ */
+void Adafruit_VCNL4020_Presence::reset() {
+  _head = 0;
+  _newSum = 0;
+  _oldSum = 0;
+  _run = 0;
+  _primed = false;
+  _present = false;
+  _movement = 0;
+}
+
+/*!
+ * @brief  Feeds one proximity sample through the engine.
+ * @param  proximity  The raw or filtered proximity, 0xFFFF readings are
+ * ignored as spurious.
+ * @return The VCNL4020_PRESENCE_* events this sample caused, or 0.
+ */
+uint8_t Adafruit_VCNL4020_Presence::update(uint16_t proximity) {
+  if (proximity == 0xFFFF)
+    return 0;
+
+  if (!_primed) {
+    // Start from a flat window so the slope begins at zero
+    for (uint8_t i = 0; i < VCNL4020_PRESENCE_WINDOW; i++)
+      _window[i] = proximity;
+    _oldSum = _newSum = (uint32_t)proximity * VCNL4020_PRESENCE_HALF;
+    _primed = true;
+  }
+
+  // The oldest sample leaves, the oldest of the newer half moves to the
+  // older half and the new sample takes the freed slot
+  uint16_t middle =
+      _window[(_head + VCNL4020_PRESENCE_HALF) & VCNL4020_PRESENCE_MASK];
+  _oldSum = _oldSum + middle - _window[_head];
+  _newSum = _newSum + proximity - middle;
+  _window[_head] = proximity;
+  _head = (_head + 1) & VCNL4020_PRESENCE_MASK;
+
+  uint8_t events = 0;
+
+  // Presence changes once the level stays across the other threshold for
+  // dwell samples in a row
+  uint16_t now = level();
+  bool across = _present ? (now <= _config.exitLevel)
+                         : (now >= _config.enterLevel);
+  _run = across ? _run + 1 : 0;
+  if (_run >= _config.dwell) {
+    _present = !_present;
+    _run = 0;
+    events |= _present ? VCNL4020_PRESENCE_ENTER : VCNL4020_PRESENCE_LEAVE;
+  }
+
+  // Movement events fire once, and re-arm when the slope falls back under
+  // half the rate
+  int32_t rate = _config.approachRate;
+  int32_t change = slope();
+  if (_movement != 1 && change >= rate) {
+    _movement = 1;
+    events |= VCNL4020_PRESENCE_APPROACH;
+  } else if (_movement != -1 && change <= -rate) {
+    _movement = -1;
+    events |= VCNL4020_PRESENCE_RETREAT;
+  } else if (change < rate / 2 && change > -rate / 2) {
+    _movement = 0;
+  }
+  return events;
+}
+
+/*!
+ * @brief  Feeds the proximity of an interrupt-driven sample through the
+ * engine. Samples that only announced an ambient result are skipped.
+ * @param  sample  The sample from Adafruit_VCNL4020::fetchInterruptSample().
+ * @return The VCNL4020_PRESENCE_* events this sample caused, or 0.
+ */
+uint8_t
+Adafruit_VCNL4020_Presence::update(const vcnl4020_timed_sample &sample) {
+  if (sample.status == VCNL4020_INT_ALS_READY)
+    return 0;
+  return update(sample.proximity);
+}
+
+/*!
+ * @brief  Tells whether something is present.
+ * @return True between an ENTER and a LEAVE event.
+ */
+bool Adafruit_VCNL4020_Presence::present() { return _present; }
+
+/*!
+ * @brief  Gets the smoothed proximity the presence state is judged on.
+ * @return The mean of the newer half of the window.
+ */
+uint16_t Adafruit_VCNL4020_Presence::level() {
+  return _newSum / VCNL4020_PRESENCE_HALF;
+}
+
+/*!
+ * @brief  Gets how fast proximity is changing, positive when approaching.
+ * @return The change per sample times 16 (with the default window of 8).
+ */
+int32_t Adafruit_VCNL4020_Presence::slope() {
+  return (int32_t)(_newSum - _oldSum);
+}
@@ -0,0 +1,79 @@
+/*!
+ * @file Adafruit_VCNL4020_Presence.h
+ *
+ * Integer-only presence and approach / retreat detection on VCNL4020
+ * proximity samples, cheap enough for an 8-bit MCU at 250 samples/s.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef ADAFRUIT_VCNL4020_PRESENCE_H
+#define ADAFRUIT_VCNL4020_PRESENCE_H
+
+#include "Adafruit_VCNL4020.h"
+
+#define VCNL4020_PRESENCE_WINDOW 8 ///< Samples in the window, power of two
+
+#define VCNL4020_PRESENCE_ENTER 0x01    ///< Something arrived
+#define VCNL4020_PRESENCE_LEAVE 0x02    ///< It went away
+#define VCNL4020_PRESENCE_APPROACH 0x04 ///< Proximity started rising fast
+#define VCNL4020_PRESENCE_RETREAT 0x08  ///< Proximity started falling fast
+
+/** Tuning for Adafruit_VCNL4020_Presence */
+typedef struct {
+  uint16_t enterLevel;   ///< Level at or above which something is present
+  uint16_t exitLevel;    ///< Level at or below which it is gone
+  uint8_t dwell;         ///< Samples in a row needed to change presence
+  uint16_t approachRate; ///< Slope, counts/sample x16, for approach / retreat
+} vcnl4020_presence_config;
+
+/*!
+ * @brief Keeps a VCNL4020_PRESENCE_WINDOW sample window and updates in O(1)
+ * per sample with adds, subtracts and shifts only. The level is the mean of
+ * the newer half of the window, the slope is the newer half's sum minus the
+ * older half's: the change per sample times 16.
+ */
+class Adafruit_VCNL4020_Presence {
+public:
+  Adafruit_VCNL4020_Presence();
+
+  static void getDefaultConfig(vcnl4020_presence_config *config);
+  void begin(const vcnl4020_presence_config *config);
+  void reset();
+  uint8_t update(uint16_t proximity);
+  uint8_t update(const vcnl4020_timed_sample &sample);
+
+  /*!
+   * @brief  Feeds every sample waiting in an interrupt-driven sample buffer
+   * through the engine.
+   * @param  buffer  The buffer filled by Adafruit_VCNL4020::serviceInterrupt().
+   * @return The VCNL4020_PRESENCE_* events of all the samples, OR-ed.
+   */
+  template <uint8_t CAPACITY>
+  uint8_t update(Adafruit_VCNL4020_SampleBuffer<CAPACITY> *buffer) {
+    vcnl4020_timed_sample sample;
+    uint8_t events = 0;
+    while (buffer->read(&sample))
+      events |= update(sample);
+    return events;
+  }
+
+  bool present();
+  uint16_t level();
+  int32_t slope();
+
+private:
+  vcnl4020_presence_config _config;           ///< Tuning
+  uint16_t _window[VCNL4020_PRESENCE_WINDOW]; ///< Ring of the last samples
+  uint8_t _head;                              ///< Oldest sample slot
+  uint32_t _newSum;                           ///< Sum of the newer half
+  uint32_t _oldSum;                           ///< Sum of the older half
+
+  uint8_t _run;     ///< Samples in a row across the enter or exit level
+  bool _primed;     ///< False until the first sample filled the window
+  bool _present;    ///< Presence state
+  int8_t _movement; ///< 1 approaching, -1 retreating, 0 neither
+};
+
+#endif // ADAFRUIT_VCNL4020_PRESENCE_H
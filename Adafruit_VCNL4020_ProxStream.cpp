@@ -0,0 +1,168 @@
+/*!
+ * @file Adafruit_VCNL4020_ProxStream.cpp
+ *
+ * Optional proximity stream for the VCNL4020.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_ProxStream.h"
+
+/*!
+ * @brief  Constructs a proximity stream for a sensor, call start() to start
+ * it.
+ * @param  sensor  The sensor, already initialized with begin().
+ */
+Adafruit_VCNL4020_ProxStream::Adafruit_VCNL4020_ProxStream(
+    Adafruit_VCNL4020 *sensor) {
+  _sensor = sensor;
+  _streaming = false;
+  _period = 0;
+  _nextRead = 0;
+  _lastSample = 0;
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+/*!
+ * @brief  Starts streaming proximity samples with next(). Needs self-timed
+ * proximity measurements to be enabled.
+ * @return True if the stream was started, false if self-timed proximity
+ * measurements are not enabled.
+ */
+bool Adafruit_VCNL4020_ProxStream::start() {
+  if (!_sensor->refreshRegisters())
+    return false;
+  if (!_sensor->readField<vcnl4020_prox_en_field>() ||
+      !_sensor->readField<vcnl4020_selftimed_en_field>())
+    return false;
+
+  _period = Adafruit_VCNL4020::proxPeriodMicros(_sensor->getProxRate());
+  _nextRead = _sensor->now();
+  _lastSample = 0;
+  memset(&_stats, 0, sizeof(_stats));
+  _streaming = true;
+
+  // Start from a clean slate so the first INT edge is a fresh sample
+  if (usesInt())
+    _sensor->clearInterruptMask(VCNL4020_INT_PROX_READY);
+  return true;
+}
+
+/*!
+ * @brief  Tells whether the stream is paced by the INT pin: a pin was given
+ * and INT fires on proximity ready only.
+ * @return True if next() waits for INT, false if it paces reads itself.
+ */
+bool Adafruit_VCNL4020_ProxStream::usesInt() {
+  return (_sensor->_intPin >= 0) &&
+         ((_sensor->getInterruptControl() &
+           vcnl4020_int_sources_field::mask) ==
+          vcnl4020_int_prox_ready_field::mask);
+}
+
+/*!
+ * @brief  Stops the stream started by start().
+ */
+void Adafruit_VCNL4020_ProxStream::stop() { _streaming = false; }
+
+/*!
+ * @brief  Returns the next proximity sample of the stream, if one is due.
+ * Never blocks. With the INT pin this costs one 2-byte read plus one write to
+ * acknowledge, without it one 9-byte burst that carries the ready flag with
+ * the result. 0xFFFF readings are dropped and counted as spurious. The rate
+ * and interrupt settings are followed from the shadow cache, so changes made
+ * while streaming, e.g. by the governor, take effect on the next call.
+ * @param  proximity  Where to store the sample.
+ * @return True if a new sample was stored. False if none is due yet, or on a
+ * bus error including a failed acknowledge; the sample is then fetched again
+ * on the next call.
+ */
+bool Adafruit_VCNL4020_ProxStream::next(uint16_t *proximity) {
+  VCNL4020_SENSOR_STATS_SCOPE(_sensor, VCNL4020_OP_PROX_STREAM);
+
+  if (!_streaming)
+    return false;
+
+  uint32_t now = _sensor->now();
+  uint16_t value;
+
+  uint32_t period = Adafruit_VCNL4020::proxPeriodMicros(_sensor->getProxRate());
+  if (period != _period) {
+    // Gaps across a rate change are not drops, and the old pacing is void
+    _period = period;
+    _lastSample = 0;
+    _nextRead = now;
+  }
+
+  if (usesInt()) {
+    noInterrupts();
+    bool pending = _sensor->_intPending;
+    uint32_t edge = _sensor->_intMicros;
+    _sensor->_intPending = false;
+    interrupts();
+    if (!pending && digitalRead(_sensor->_intPin) != LOW)
+      return false;
+    if (!pending)
+      edge = now;
+    _sensor->tapInterrupt(edge);
+
+    // On a bus error INT stays low, so the edge is kept and the sample is
+    // fetched again next call
+    uint8_t buffer[2];
+    if (!_sensor->busRead(VCNL4020_REG_PROX_RESULT_HIGH, buffer, 2) ||
+        !_sensor->clearInterruptMask(VCNL4020_INT_PROX_READY)) {
+      _sensor->handleInterrupt(edge);
+      return false;
+    }
+    value = _sensor->compensate(((uint16_t)buffer[0] << 8) | buffer[1]);
+  } else {
+    if ((int32_t)(now - _nextRead) < 0)
+      return false;
+
+    vcnl4020_sample sample;
+    if (!_sensor->readSample(&sample))
+      return false;
+    if (!sample.proxReady) {
+      // The chip clock runs a little slow of ours, check back shortly
+      _stats.duplicated++;
+      _nextRead = now + _period / 8;
+      return false;
+    }
+    value = sample.proximity;
+    _nextRead = now + _period - _period / 8;
+  }
+
+  // More than one and a half periods since the last sample means we missed
+  // at least one conversion
+  if (_lastSample != 0) {
+    uint32_t gap = now - _lastSample;
+    if (gap > _period + _period / 2)
+      _stats.dropped += (gap + _period / 2) / _period - 1;
+  }
+  _lastSample = now;
+
+  if (value == 0xFFFF) {
+    _stats.spurious++;
+    return false;
+  }
+
+  Adafruit_VCNL4020_Filter *filter = _sensor->_proxFilter;
+  if (filter) {
+    if (!filter->push(value))
+      return false;
+    value = filter->output();
+  }
+
+  _stats.delivered++;
+  *proximity = value;
+  return true;
+}
+
+/*!
+ * @brief  Gets the counters of the stream.
+ * @return The counters since the last start().
+ */
+vcnl4020_stream_stats Adafruit_VCNL4020_ProxStream::getStats() {
+  return _stats;
+}
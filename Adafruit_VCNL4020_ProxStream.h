@@ -0,0 +1,52 @@
+/*!
+ * @file Adafruit_VCNL4020_ProxStream.h
+ *
+ * Optional proximity stream for the VCNL4020: hands out each self-timed
+ * proximity result once, paced by the INT pin or by the measurement rate,
+ * and counts the samples that were missed on the way.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef ADAFRUIT_VCNL4020_PROXSTREAM_H
+#define ADAFRUIT_VCNL4020_PROXSTREAM_H
+
+#include "Adafruit_VCNL4020.h"
+
+/** Counters kept by the proximity stream, see next() */
+typedef struct {
+  uint32_t delivered;  ///< Samples returned by next()
+  uint32_t dropped;    ///< Conversions missed between two delivered samples
+  uint32_t duplicated; ///< Reads that found no new conversion yet
+  uint32_t spurious;   ///< 0xFFFF readings filtered out
+} vcnl4020_stream_stats;
+
+/*!
+ * @brief Streams self-timed proximity samples without a separate status poll
+ * per sample. If setInterruptPin() was given and the INT pin fires on
+ * proximity ready only, the pin tells when a sample is waiting; otherwise
+ * reads are paced off the configured proximity rate. Samples pass through the
+ * sensor's proximity filter, if one is set.
+ */
+class Adafruit_VCNL4020_ProxStream {
+public:
+  Adafruit_VCNL4020_ProxStream(Adafruit_VCNL4020 *sensor);
+
+  bool start();
+  void stop();
+  bool next(uint16_t *proximity);
+  vcnl4020_stream_stats getStats();
+
+private:
+  Adafruit_VCNL4020 *_sensor;   ///< The sensor being streamed
+  bool _streaming;              ///< True between start() and stop()
+  uint32_t _period;             ///< Prox measurement period in us
+  uint32_t _nextRead;           ///< micros() of the next paced read
+  uint32_t _lastSample;         ///< micros() of the last delivered sample
+  vcnl4020_stream_stats _stats; ///< Stream counters
+
+  bool usesInt();
+};
+
+#endif // ADAFRUIT_VCNL4020_PROXSTREAM_H
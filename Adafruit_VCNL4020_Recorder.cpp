@@ -0,0 +1,96 @@
+/*!
+ * @file Adafruit_VCNL4020_Recorder.cpp
+ *
+ * Optional timestamped records for the VCNL4020.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Recorder.h"
+
+/*!
+ * @brief  Constructs a recorder for a sensor, with both sequence numbers at
+ * 0.
+ * @param  sensor  The sensor, already initialized with begin().
+ */
+Adafruit_VCNL4020_Recorder::Adafruit_VCNL4020_Recorder(
+    Adafruit_VCNL4020 *sensor) {
+  _sensor = sensor;
+  _lastRead = 0;
+  memset(_time, 0, sizeof(_time));
+  memset(_sequence, 0, sizeof(_sequence));
+}
+
+/*!
+ * @brief  Reads both results in one burst and stamps them. A result read
+ * again keeps its sequence number and timestamp, with fresh false. Both
+ * ready flags clear on every burst, so read both channels together.
+ * @param  ambient    Where to store the ambient record, or NULL.
+ * @param  proximity  Where to store the proximity record, or NULL.
+ * @return True if the read succeeded, otherwise false.
+ */
+bool Adafruit_VCNL4020_Recorder::read(vcnl4020_record *ambient,
+                                      vcnl4020_record *proximity) {
+  VCNL4020_SENSOR_STATS_SCOPE(_sensor, VCNL4020_OP_READ_RECORDS);
+
+  vcnl4020_sample sample;
+  if (!_sensor->readSample(&sample))
+    return false;
+
+  uint32_t now = _sensor->now();
+  stamp(VCNL4020_CHANNEL_AMBIENT, sample.ambient, sample.ambientReady, now,
+        ambient);
+  stamp(VCNL4020_CHANNEL_PROXIMITY, sample.proximity, sample.proxReady, now,
+        proximity);
+  _lastRead = now;
+  return true;
+}
+
+/*!
+ * @brief  Fills in one record of a read() burst.
+ * @param  channel  The channel the value belongs to.
+ * @param  value    The result.
+ * @param  fresh    True if the channel's ready flag was set.
+ * @param  now      micros() right after the burst.
+ * @param  record   Where to store the record, or NULL.
+ */
+void Adafruit_VCNL4020_Recorder::stamp(vcnl4020_channel channel,
+                                       uint16_t value, bool fresh,
+                                       uint32_t now, vcnl4020_record *record) {
+  bool als = channel == VCNL4020_CHANNEL_AMBIENT;
+
+  if (fresh) {
+    uint32_t period = _sensor->channelPeriodMicros(channel);
+    uint8_t ready = als ? vcnl4020_int_als_ready_field::mask
+                        : vcnl4020_int_prox_ready_field::mask;
+
+    noInterrupts();
+    uint32_t edge = _sensor->_intMicros;
+    interrupts();
+
+    uint32_t done;
+    if (_sensor->_intPin >= 0 &&
+        (_sensor->getInterruptControl() & vcnl4020_int_sources_field::mask) ==
+            ready &&
+        now - edge <= period) {
+      // The INT pin fell when this conversion finished
+      done = edge;
+    } else {
+      uint32_t window = now - _lastRead;
+      if (_lastRead == 0 || window > period)
+        window = period;
+      done = now - window / 2;
+    }
+    _time[channel] = done - _sensor->conversionMicros(als, !als) / 2;
+    _sequence[channel]++;
+  }
+
+  if (!record)
+    return;
+  record->timestamp = _time[channel];
+  record->value = value;
+  record->sequence = _sequence[channel];
+  record->channel = channel;
+  record->fresh = fresh;
+}
@@ -0,0 +1,50 @@
+/*!
+ * @file Adafruit_VCNL4020_Recorder.h
+ *
+ * Optional timestamped records for the VCNL4020: numbers each new result and
+ * estimates when it was measured, so results from several sensors can be
+ * lined up in time.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef ADAFRUIT_VCNL4020_RECORDER_H
+#define ADAFRUIT_VCNL4020_RECORDER_H
+
+#include "Adafruit_VCNL4020.h"
+
+/** One result with an estimate of when it was measured */
+typedef struct {
+  uint32_t timestamp;       ///< Estimated micros() at mid-conversion
+  uint16_t value;           ///< The result
+  uint16_t sequence;        ///< Per-channel conversion count, wraps
+  vcnl4020_channel channel; ///< Which measurement value holds
+  bool fresh;               ///< False if returned by an earlier call
+} vcnl4020_record;
+
+/*!
+ * @brief Reads both results of a sensor as timestamped, numbered records. A
+ * result whose ready flag is set gets a new sequence number and a timestamp
+ * taken from the INT pin edge, if setInterruptPin() was given and only that
+ * channel's ready interrupt is enabled, or else the midpoint of the window
+ * it must have finished in: since the previous read, at most one
+ * measurement period. Half the conversion time is then taken off.
+ */
+class Adafruit_VCNL4020_Recorder {
+public:
+  Adafruit_VCNL4020_Recorder(Adafruit_VCNL4020 *sensor);
+
+  bool read(vcnl4020_record *ambient, vcnl4020_record *proximity);
+
+private:
+  Adafruit_VCNL4020 *_sensor; ///< The sensor being recorded
+  uint32_t _lastRead;         ///< micros() of the last read() burst
+  uint32_t _time[2];          ///< Estimated time of each channel's result
+  uint16_t _sequence[2];      ///< Conversion count of each channel
+
+  void stamp(vcnl4020_channel channel, uint16_t value, bool fresh,
+             uint32_t now, vcnl4020_record *record);
+};
+
+#endif // ADAFRUIT_VCNL4020_RECORDER_H
@@ -0,0 +1,107 @@
+/*!
+ * @file Adafruit_VCNL4020_SampleBuffer.h
+ *
+ * Fixed-capacity single-producer / single-consumer ring buffer of timestamped
+ * VCNL4020 samples, filled by Adafruit_VCNL4020::serviceInterrupt().
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef ADAFRUIT_VCNL4020_SAMPLEBUFFER_H
+#define ADAFRUIT_VCNL4020_SAMPLEBUFFER_H
+
+#include "Arduino.h"
+
+/** One sample fetched after an INT pin edge */
+typedef struct {
+  uint32_t timestamp; ///< micros() when the INT pin fired
+  uint16_t ambient;   ///< Ambient light result
+  uint16_t proximity; ///< Proximity result
+  uint8_t status;     ///< VCNL4020_INT_* flags that were set for this sample
+} vcnl4020_timed_sample;
+
+/*!
+ * @brief Lock-free ring buffer of vcnl4020_timed_sample. One context may push
+ * while another reads, without disabling interrupts. No heap is used; one slot
+ * is kept empty to tell full from empty.
+ * @tparam CAPACITY Number of slots, 2 - 255. Holds CAPACITY - 1 samples.
+ */
+template <uint8_t CAPACITY> class Adafruit_VCNL4020_SampleBuffer {
+public:
+  /*!
+   * @brief  Adds a sample, called by the producer only.
+   * @param  sample  The sample to add.
+   * @return True if stored, false if the buffer was full and the sample was
+   * dropped (counted by overflows()).
+   */
+  bool push(const vcnl4020_timed_sample &sample) {
+    uint8_t head = _head;
+    uint8_t next = (head + 1 == CAPACITY) ? 0 : head + 1;
+    if (next == _tail) {
+      _overflows++;
+      return false;
+    }
+    _samples[head] = sample;
+    // Make sure the slot is written before the consumer can see it
+    __asm__ __volatile__("" ::: "memory");
+    _head = next;
+    return true;
+  }
+
+  /*!
+   * @brief  How many samples are waiting, called by the consumer.
+   * @return The number of samples that read() can return.
+   */
+  uint8_t available() const {
+    uint8_t head = _head, tail = _tail;
+    return (head >= tail) ? head - tail : CAPACITY - tail + head;
+  }
+
+  /*!
+   * @brief  Takes up to len samples out of the buffer, called by the consumer.
+   * @param  samples  Where to copy the samples, oldest first.
+   * @param  len      Room in samples.
+   * @return How many samples were copied.
+   */
+  uint8_t read(vcnl4020_timed_sample *samples, uint8_t len) {
+    uint8_t count = 0;
+    uint8_t tail = _tail;
+    while (count < len && tail != _head) {
+      __asm__ __volatile__("" ::: "memory");
+      samples[count++] = _samples[tail];
+      tail = (tail + 1 == CAPACITY) ? 0 : tail + 1;
+    }
+    __asm__ __volatile__("" ::: "memory");
+    _tail = tail;
+    return count;
+  }
+
+  /*!
+   * @brief  Takes the oldest sample out of the buffer.
+   * @param  sample  Where to copy the sample.
+   * @return True if a sample was available.
+   */
+  bool read(vcnl4020_timed_sample *sample) { return read(sample, 1) == 1; }
+
+  /*!
+   * @brief  How many samples were dropped because the buffer was full.
+   * @return The overflow count since construction or clearOverflows().
+   */
+  uint16_t overflows() const { return _overflows; }
+
+  /*!
+   * @brief  Resets the overflow count, only call while the producer is idle.
+   */
+  void clearOverflows() { _overflows = 0; }
+
+private:
+  static_assert(CAPACITY >= 2, "Sample buffer needs at least two slots");
+
+  vcnl4020_timed_sample _samples[CAPACITY]; ///< Sample storage
+  volatile uint8_t _head = 0;               ///< Producer's next slot
+  volatile uint8_t _tail = 0;               ///< Consumer's next slot
+  volatile uint16_t _overflows = 0;         ///< Samples dropped while full
+};
+
+#endif // ADAFRUIT_VCNL4020_SAMPLEBUFFER_H
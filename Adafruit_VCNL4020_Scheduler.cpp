@@ -0,0 +1,322 @@
+/*!
+ * @file Adafruit_VCNL4020_Scheduler.cpp
+ *
+ * Optional interleaved ALS / proximity measurement scheduler for the
+ * VCNL4020.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Scheduler.h"
+
+/*!
+ * @brief  Constructs a scheduler for a sensor, call begin() to start it.
+ * @param  sensor  The sensor, already initialized with begin().
+ */
+Adafruit_VCNL4020_Scheduler::Adafruit_VCNL4020_Scheduler(
+    Adafruit_VCNL4020 *sensor)
+    : _measurement(sensor) {
+  _sensor = sensor;
+  _busy = false;
+  _alsPaused = false;
+  getDefaultConfig(&_config);
+  plan(&_config, &_plan);
+  resetStats();
+}
+
+/*!
+ * @brief  Fills in a config asking for proximity as fast as possible with no
+ * gap over 10 ms, and ambient light 5 times a second with up to 8 samples
+ * averaged.
+ * @param  config  The config to fill in.
+ */
+void Adafruit_VCNL4020_Scheduler::getDefaultConfig(
+    vcnl4020_schedule_config *config) {
+  config->proxPeriod = 0;
+  config->proxLatency = 10000;
+  config->alsPeriod = 200000;
+  config->alsLatency = 250000;
+  config->maxAveraging = AVG_8_SAMPLES;
+}
+
+/*!
+ * @brief  Works out how to meet a config without touching the sensor, so the
+ * choice can be checked up front. See the class description for the rules.
+ * @param  config  Targets and budgets.
+ * @param  plan    Where to store the modes and rates.
+ */
+void Adafruit_VCNL4020_Scheduler::plan(const vcnl4020_schedule_config *config,
+                                       vcnl4020_schedule_plan *plan) {
+  memset(plan, 0, sizeof(*plan));
+
+  // Average as much as the proximity and ALS latency budgets allow
+  uint8_t averaging = config->maxAveraging;
+  uint32_t stall = 0;
+  if (config->alsPeriod) {
+    while (averaging > AVG_1_SAMPLES &&
+           (alsMicros((vcnl4020_averaging)averaging) + 1000 >
+                config->proxLatency ||
+            alsMicros((vcnl4020_averaging)averaging) > config->alsLatency))
+      averaging--;
+    stall = alsMicros((vcnl4020_averaging)averaging);
+  }
+  plan->averaging = (vcnl4020_averaging)averaging;
+
+  // The slowest self-timed proximity rate that meets the period, with an ALS
+  // stall on top still within the latency
+  plan->proxMode = VCNL4020_SCHED_ONDEMAND;
+  plan->proxPeriod = 1000;
+  for (uint8_t rate = PROX_RATE_1_95_PER_S;
+       config->proxPeriod && rate <= PROX_RATE_250_PER_S; rate++) {
+    uint32_t period =
+        Adafruit_VCNL4020::proxPeriodMicros((vcnl4020_proxrate)rate);
+    if (period <= config->proxPeriod &&
+        period + stall <= config->proxLatency) {
+      plan->proxMode = VCNL4020_SCHED_SELFTIMED;
+      plan->proxRate = (vcnl4020_proxrate)rate;
+      plan->proxPeriod = period;
+      break;
+    }
+  }
+
+  if (!config->alsPeriod)
+    return;
+  plan->alsPeriod = min(config->alsPeriod, config->alsLatency);
+  plan->alsMode = VCNL4020_SCHED_ONDEMAND;
+  if (plan->proxMode != VCNL4020_SCHED_SELFTIMED)
+    return;
+
+  // Self-time ALS too if that converts no more than twice as often as asked
+  for (uint8_t rate = AMBIENT_RATE_1_SPS; rate <= AMBIENT_RATE_10_SPS;
+       rate++) {
+    uint32_t period =
+        Adafruit_VCNL4020::ambientPeriodMicros((vcnl4020_ambientrate)rate);
+    if (period <= plan->alsPeriod) {
+      if (period > plan->alsPeriod / 2) {
+        plan->alsMode = VCNL4020_SCHED_SELFTIMED;
+        plan->ambientRate = (vcnl4020_ambientrate)rate;
+        plan->alsPeriod = period;
+      }
+      break;
+    }
+  }
+}
+
+/*!
+ * @brief  Plans the config and programs the sensor for it. Takes over the
+ * command register, the proximity and ambient rates, the ALS averaging and
+ * continuous conversion; the application should not change them while the
+ * scheduler runs.
+ * @param  config  Targets and budgets.
+ * @return True if the sensor was programmed.
+ */
+bool Adafruit_VCNL4020_Scheduler::begin(
+    const vcnl4020_schedule_config *config) {
+  _config = *config;
+  plan(&_config, &_plan);
+
+  bool selfTimed = _plan.proxMode == VCNL4020_SCHED_SELFTIMED;
+  bool als = _plan.alsMode == VCNL4020_SCHED_SELFTIMED;
+
+  vcnl4020_config chip;
+  if (!_sensor->getConfig(&chip))
+    return false;
+  chip.proxRate = selfTimed ? _plan.proxRate : chip.proxRate;
+  chip.ambientRate = als ? _plan.ambientRate : chip.ambientRate;
+  chip.ambientAveraging = _plan.averaging;
+  chip.continuousConversion = false;
+  chip.alsEnable = als;
+  chip.proxEnable = selfTimed;
+  chip.selfTimed = selfTimed;
+
+  _busy = false;
+  _alsPaused = false;
+  resetStats();
+  _nextRead = _statsStart + _plan.proxPeriod;
+  _nextAls = _statsStart;
+  return _sensor->applyConfig(&chip);
+}
+
+/*!
+ * @brief  Runs the schedule: call as often as possible from loop(). Never
+ * blocks, and only touches the bus when a result is due or a conversion has
+ * to be started.
+ * @param  sample  Where to store new results. The ready flags tell which of
+ * the values are new.
+ * @return True if a new proximity or ALS result was stored.
+ */
+bool Adafruit_VCNL4020_Scheduler::update(vcnl4020_sample *sample) {
+  uint32_t now = _sensor->now();
+  bool fresh = (_plan.proxMode == VCNL4020_SCHED_SELFTIMED)
+                   ? updateSelfTimed(now, sample)
+                   : updateOnDemand(now, sample);
+  if (fresh)
+    count(sample, now);
+  return fresh;
+}
+
+/*!
+ * @brief  Gets the modes and rates begin() chose.
+ * @param  plan  Where to store the plan.
+ */
+void Adafruit_VCNL4020_Scheduler::getPlan(vcnl4020_schedule_plan *plan) {
+  *plan = _plan;
+}
+
+/*!
+ * @brief  Gets the rates achieved and the longest gaps seen since begin() or
+ * resetStats().
+ * @param  stats  Where to store the stats.
+ */
+void Adafruit_VCNL4020_Scheduler::getStats(vcnl4020_schedule_stats *stats) {
+  uint32_t elapsed = _sensor->now() - _statsStart;
+  *stats = _stats;
+  if (elapsed) {
+    stats->proxMilliHz = (uint64_t)_proxCount * 1000000000ULL / elapsed;
+    stats->alsMilliHz = (uint64_t)_alsCount * 1000000000ULL / elapsed;
+  }
+}
+
+/*!
+ * @brief  Starts a new measurement window for getStats().
+ */
+void Adafruit_VCNL4020_Scheduler::resetStats() {
+  memset(&_stats, 0, sizeof(_stats));
+  _statsStart = _sensor->now();
+  _proxCount = 0;
+  _alsCount = 0;
+  _lastProx = _statsStart;
+  _lastAls = _statsStart;
+}
+
+/*!
+ * @brief  One step with self-timed proximity: reads on the chip's cadence
+ * like Adafruit_VCNL4020_ProxStream::next(), and runs on-demand ALS
+ * conversions in a pause of the self-timed cycle.
+ * @param  now     micros() of this step.
+ * @param  sample  Where to store new results.
+ * @return True if a new result was stored.
+ */
+bool Adafruit_VCNL4020_Scheduler::updateSelfTimed(uint32_t now,
+                                                  vcnl4020_sample *sample) {
+  if (_alsPaused) {
+    vcnl4020_meas_state state = _measurement.poll();
+    if (state == VCNL4020_MEAS_BUSY)
+      return false;
+    bool done = _measurement.result(sample);
+    if (!done)
+      _stats.timeouts++;
+
+    // Resume the self-timed cycle; on a bus error try again next step
+    if (!_sensor->enable(false, true, true))
+      return false;
+    _alsPaused = false;
+    _nextRead = now + _plan.proxPeriod / 2;
+    return done && sample->ambientReady;
+  }
+
+  if ((int32_t)(now - _nextRead) < 0)
+    return false;
+  if (!_sensor->readSample(sample))
+    return false;
+  // On-demand ALS results are collected in the pause, not here
+  sample->ambientReady &= _plan.alsMode == VCNL4020_SCHED_SELFTIMED;
+
+  uint32_t period = _plan.proxPeriod;
+  if (!sample->proxReady) {
+    // An ALS conversion may be holding proximity up, check back shortly
+    _nextRead = now + period / 8;
+    return sample->ambientReady;
+  }
+  _nextRead = now + period - period / 8;
+
+  // Right after a proximity result the ALS stall delays the fewest samples
+  if (_plan.alsMode == VCNL4020_SCHED_ONDEMAND &&
+      (int32_t)(now - _nextAls) >= 0 && _sensor->enable(false, true, false)) {
+    _alsPaused = trigger(now);
+    if (!_alsPaused)
+      _sensor->enable(false, true, true);
+  }
+  return true;
+}
+
+/*!
+ * @brief  One step with on-demand proximity: collects the running
+ * conversion and starts the next one straight away.
+ * @param  now     micros() of this step.
+ * @param  sample  Where to store new results.
+ * @return True if a new result was stored.
+ */
+bool Adafruit_VCNL4020_Scheduler::updateOnDemand(uint32_t now,
+                                                 vcnl4020_sample *sample) {
+  bool fresh = false;
+  if (_busy) {
+    vcnl4020_meas_state state = _measurement.poll();
+    if (state == VCNL4020_MEAS_BUSY)
+      return false;
+    fresh = _measurement.result(sample);
+    if (!fresh)
+      _stats.timeouts++;
+  }
+  _busy = trigger(now);
+  return fresh;
+}
+
+/*!
+ * @brief  Starts an on-demand conversion: ALS if it is due, plus proximity
+ * unless proximity is self-timed.
+ * @param  now  micros() of this step.
+ * @return True if a conversion was started.
+ */
+bool Adafruit_VCNL4020_Scheduler::trigger(uint32_t now) {
+  bool als = _plan.alsMode == VCNL4020_SCHED_ONDEMAND &&
+             (int32_t)(now - _nextAls) >= 0;
+  bool prox = _plan.proxMode == VCNL4020_SCHED_ONDEMAND;
+  if (!_measurement.request(als, prox))
+    return false;
+
+  if (als) {
+    // Keep the ALS period on average, but never trigger a burst to catch up
+    _nextAls += _plan.alsPeriod;
+    if ((int32_t)(now - _nextAls) >= 0)
+      _nextAls = now + _plan.alsPeriod;
+  }
+  return true;
+}
+
+/*!
+ * @brief  Counts the new results of a sample and tracks the gaps between
+ * them against the latency budgets.
+ * @param  sample  The sample update() stored.
+ * @param  now     micros() of this step.
+ */
+void Adafruit_VCNL4020_Scheduler::count(const vcnl4020_sample *sample,
+                                        uint32_t now) {
+  if (sample->proxReady) {
+    uint32_t gap = now - _lastProx;
+    _stats.proxMaxGap = max(_stats.proxMaxGap, gap);
+    if (gap > _config.proxLatency)
+      _stats.proxLate++;
+    _lastProx = now;
+    _proxCount++;
+  }
+  if (sample->ambientReady) {
+    uint32_t gap = now - _lastAls;
+    _stats.alsMaxGap = max(_stats.alsMaxGap, gap);
+    if (gap > _config.alsLatency)
+      _stats.alsLate++;
+    _lastAls = now;
+    _alsCount++;
+  }
+}
+
+/*!
+ * @brief  Estimates an ALS conversion time, as
+ * Adafruit_VCNL4020::conversionMicros() does.
+ * @param  averaging  The ALS averaging.
+ * @return The conversion time in microseconds.
+ */
+uint32_t Adafruit_VCNL4020_Scheduler::alsMicros(vcnl4020_averaging averaging) {
+  return 1000UL << averaging;
+}
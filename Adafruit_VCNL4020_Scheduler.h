@@ -0,0 +1,102 @@
+/*!
+ * @file Adafruit_VCNL4020_Scheduler.h
+ *
+ * Optional measurement scheduler for the VCNL4020: interleaves ambient light
+ * and proximity conversions to get the most proximity results out of the chip
+ * while still meeting an ambient light rate.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef ADAFRUIT_VCNL4020_SCHEDULER_H
+#define ADAFRUIT_VCNL4020_SCHEDULER_H
+
+#include "Adafruit_VCNL4020_Measurement.h"
+
+/** How the scheduler runs one channel */
+typedef enum {
+  VCNL4020_SCHED_OFF,       ///< Not measured
+  VCNL4020_SCHED_SELFTIMED, ///< Timed by the chip at one of its fixed rates
+  VCNL4020_SCHED_ONDEMAND   ///< Triggered by the scheduler when due
+} vcnl4020_sched_mode;
+
+/** What the application needs, see Adafruit_VCNL4020_Scheduler::plan() */
+typedef struct {
+  uint32_t proxPeriod;  ///< Proximity result every this many us, 0 = fastest
+  uint32_t proxLatency; ///< Longest acceptable gap between proximity results
+  uint32_t alsPeriod;   ///< ALS result every this many us, 0 = no ALS
+  uint32_t alsLatency;  ///< Longest acceptable gap between ALS results
+  vcnl4020_averaging maxAveraging; ///< Most ALS averaging wanted
+} vcnl4020_schedule_config;
+
+/** How the scheduler meets a vcnl4020_schedule_config */
+typedef struct {
+  vcnl4020_sched_mode proxMode;     ///< How proximity is measured
+  vcnl4020_sched_mode alsMode;      ///< How ambient light is measured
+  vcnl4020_proxrate proxRate;       ///< Proximity rate when self-timed
+  vcnl4020_ambientrate ambientRate; ///< Ambient rate when self-timed
+  vcnl4020_averaging averaging;     ///< ALS averaging, fitted to the budgets
+  uint32_t proxPeriod; ///< Time between proximity results in us, ALS aside
+  uint32_t alsPeriod;  ///< Expected time between ALS results in us
+} vcnl4020_schedule_plan;
+
+/** What the scheduler achieved since begin() or resetStats() */
+typedef struct {
+  uint32_t proxMilliHz; ///< Proximity results per 1000 s
+  uint32_t alsMilliHz;  ///< ALS results per 1000 s
+  uint32_t proxMaxGap;  ///< Longest time between two proximity results in us
+  uint32_t alsMaxGap;   ///< Longest time between two ALS results in us
+  uint32_t proxLate;    ///< Proximity gaps longer than proxLatency
+  uint32_t alsLate;     ///< ALS gaps longer than alsLatency
+  uint32_t timeouts;    ///< On-demand conversions that never completed
+} vcnl4020_schedule_stats;
+
+/*!
+ * @brief Picks self-timed or on-demand mode per channel and sequences the
+ * conversions from update(). An ALS conversion of N averaged samples takes
+ * about N ms and stalls proximity for as long, so averaging is first lowered
+ * until the stall fits both latency budgets. Proximity is then self-timed if
+ * one of the chip's rates meets its period and latency, else triggered back
+ * to back on demand for the highest throughput, with ALS riding along in the
+ * same trigger when it is due. With self-timed proximity, ALS is self-timed
+ * too if a chip rate is close to its period, else triggered in a short pause
+ * of the self-timed cycle right after a proximity result.
+ */
+class Adafruit_VCNL4020_Scheduler {
+public:
+  Adafruit_VCNL4020_Scheduler(Adafruit_VCNL4020 *sensor);
+
+  static void getDefaultConfig(vcnl4020_schedule_config *config);
+  static void plan(const vcnl4020_schedule_config *config,
+                   vcnl4020_schedule_plan *plan);
+  bool begin(const vcnl4020_schedule_config *config);
+  bool update(vcnl4020_sample *sample);
+  void getPlan(vcnl4020_schedule_plan *plan);
+  void getStats(vcnl4020_schedule_stats *stats);
+  void resetStats();
+
+private:
+  Adafruit_VCNL4020 *_sensor;       ///< The sensor being scheduled
+  Adafruit_VCNL4020_Measurement _measurement; ///< On-demand conversions
+  vcnl4020_schedule_config _config; ///< Targets and budgets
+  vcnl4020_schedule_plan _plan;     ///< Modes and rates in use
+  vcnl4020_schedule_stats _stats;   ///< Gaps and counters
+  uint32_t _statsStart;             ///< micros() when the stats were reset
+  uint32_t _proxCount;              ///< Proximity results since _statsStart
+  uint32_t _alsCount;               ///< ALS results since _statsStart
+  uint32_t _lastProx;               ///< micros() of the last proximity result
+  uint32_t _lastAls;                ///< micros() of the last ALS result
+  uint32_t _nextRead;               ///< micros() of the next self-timed read
+  uint32_t _nextAls;                ///< micros() the next ALS trigger is due
+  bool _busy;                       ///< An on-demand conversion is running
+  bool _alsPaused;                  ///< Self-timing is paused for ALS
+
+  bool updateSelfTimed(uint32_t now, vcnl4020_sample *sample);
+  bool updateOnDemand(uint32_t now, vcnl4020_sample *sample);
+  bool trigger(uint32_t now);
+  void count(const vcnl4020_sample *sample, uint32_t now);
+  static uint32_t alsMicros(vcnl4020_averaging averaging);
+};
+
+#endif // ADAFRUIT_VCNL4020_SCHEDULER_H
@@ -0,0 +1,148 @@
+/*!
+ * @file Adafruit_VCNL4020_Telemetry.cpp
+ *
+ * Compact binary framing of VCNL4020 samples for high-rate streams.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Telemetry.h"
+
+/*!
+ * @brief  Sets up the encoder on a caller supplied frame buffer.
+ * @param  buffer  Where frames are built, must stay alive with the encoder.
+ * @param  size    Size of buffer. Frames carry at most 255 record bytes, so
+ * anything over 261 bytes is not used.
+ */
+Adafruit_VCNL4020_Telemetry::Adafruit_VCNL4020_Telemetry(uint8_t *buffer,
+                                                         uint16_t size) {
+  _buffer = buffer;
+  _size = size > 255 + VCNL4020_TELEMETRY_OVERHEAD
+              ? 255 + VCNL4020_TELEMETRY_OVERHEAD
+              : size;
+  reset();
+}
+
+/*!
+ * @brief  Drops the records added so far and starts a new frame.
+ */
+void Adafruit_VCNL4020_Telemetry::reset() {
+  _used = VCNL4020_TELEMETRY_HEADER;
+  _count = 0;
+  _seen = 0;
+}
+
+/*!
+ * @brief  Appends a record to the frame. A sensor's first record in a frame
+ * takes 11 bytes, later ones usually 5 - 7.
+ * @param  record  The record, sensor ids above 7 are folded into 0 - 7.
+ * @return True if added, false if the frame is full: send() it and add the
+ * record again.
+ */
+bool Adafruit_VCNL4020_Telemetry::add(
+    const vcnl4020_telemetry_record &record) {
+  uint8_t sensor = record.sensor & (VCNL4020_TELEMETRY_SENSORS - 1);
+  vcnl4020_telemetry_record *last = &_last[sensor];
+  uint8_t packed[16];
+  uint8_t len = 1;
+
+  if (!(_seen & (1 << sensor))) {
+    packed[0] = sensor | VCNL4020_TELEMETRY_ABSOLUTE;
+    const uint16_t words[] = {record.sequence, (uint16_t)record.timestamp,
+                              (uint16_t)(record.timestamp >> 16),
+                              record.ambient, record.proximity};
+    for (uint8_t i = 0; i < 5; i++) {
+      packed[len++] = words[i] & 0xFF;
+      packed[len++] = words[i] >> 8;
+    }
+  } else {
+    packed[0] = sensor;
+    int32_t ambient = (int32_t)record.ambient - last->ambient;
+    int32_t proximity = (int32_t)record.proximity - last->proximity;
+    uint16_t sequence = record.sequence - last->sequence;
+    len += putVarint(&packed[len], sequence);
+    len += putVarint(&packed[len], record.timestamp - last->timestamp);
+    len += putVarint(&packed[len], zigzag(ambient));
+    len += putVarint(&packed[len], zigzag(proximity));
+  }
+
+  if (_count == 255 || _used + len + 2 > _size ||
+      _used + len - VCNL4020_TELEMETRY_HEADER > 255)
+    return false;
+
+  memcpy(&_buffer[_used], packed, len);
+  _used += len;
+  _count++;
+  _seen |= 1 << sensor;
+  *last = record;
+  return true;
+}
+
+/*!
+ * @brief  How many records are in the frame.
+ * @return The record count.
+ */
+uint8_t Adafruit_VCNL4020_Telemetry::count() { return _count; }
+
+/*!
+ * @brief  Fills in the header and CRC of the frame. More records may still be
+ * added afterwards, as long as finish() is called again.
+ * @return The frame length in bytes, see frame().
+ */
+uint16_t Adafruit_VCNL4020_Telemetry::finish() {
+  _buffer[0] = VCNL4020_TELEMETRY_SYNC1;
+  _buffer[1] = VCNL4020_TELEMETRY_SYNC2;
+  _buffer[2] = _used - VCNL4020_TELEMETRY_HEADER;
+  _buffer[3] = _count;
+  uint16_t crc = Adafruit_VCNL4020::crc16(&_buffer[2], _used - 2);
+  _buffer[_used] = crc & 0xFF;
+  _buffer[_used + 1] = crc >> 8;
+  return _used + 2;
+}
+
+/*!
+ * @brief  Gives access to the frame filled in by finish().
+ * @return The start of the frame.
+ */
+const uint8_t *Adafruit_VCNL4020_Telemetry::frame() { return _buffer; }
+
+/*!
+ * @brief  Finishes the frame, writes it in one go and starts a new one.
+ * Nothing is written if the frame has no records.
+ * @param  out  Where to write the frame, e.g. &Serial.
+ * @return The number of bytes written.
+ */
+size_t Adafruit_VCNL4020_Telemetry::send(Print *out) {
+  if (_count == 0)
+    return 0;
+  size_t written = out->write(_buffer, finish());
+  reset();
+  return written;
+}
+
+/*!
+ * @brief  Maps a signed change to an unsigned one so small changes of either
+ * sign make short varints: 0, -1, 1, -2 ... become 0, 1, 2, 3 ...
+ * @param  value  The signed change.
+ * @return The zigzag encoded change.
+ */
+uint32_t Adafruit_VCNL4020_Telemetry::zigzag(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/*!
+ * @brief  Writes an unsigned LEB128 varint, 7 bits per byte, low bits first.
+ * @param  out    Where to write, room for 5 bytes.
+ * @param  value  The value.
+ * @return How many bytes were written.
+ */
+uint8_t Adafruit_VCNL4020_Telemetry::putVarint(uint8_t *out, uint32_t value) {
+  uint8_t len = 0;
+  while (value >= 0x80) {
+    out[len++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  out[len++] = value;
+  return len;
+}
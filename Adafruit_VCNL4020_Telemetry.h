@@ -0,0 +1,72 @@
+/*!
+ * @file Adafruit_VCNL4020_Telemetry.h
+ *
+ * Compact binary framing of VCNL4020 samples for high-rate streams, instead
+ * of printing text per sample. extras/vcnl4020_telemetry_decode.py turns the
+ * frames back into CSV on the host.
+ *
+ * Frame layout, multi-byte fields little-endian:
+ *
+ *     0xA5 0x5A | length | count | records ... | CRC-16
+ *
+ * length is the number of record bytes and count the number of records. The
+ * CRC-16/CCITT-FALSE covers length, count and the records. Each record starts
+ * with a byte holding the sensor id (bits 2-0) and VCNL4020_TELEMETRY_ABSOLUTE
+ * (bit 3). The first record of a sensor in a frame is absolute: sequence (2),
+ * timestamp (4), ambient (2), proximity (2). Later ones are varints relative
+ * to that sensor's previous record: sequence step, timestamp step, then
+ * zigzag ambient and proximity changes.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef ADAFRUIT_VCNL4020_TELEMETRY_H
+#define ADAFRUIT_VCNL4020_TELEMETRY_H
+
+#include "Adafruit_VCNL4020.h"
+
+#define VCNL4020_TELEMETRY_SYNC1 0xA5    ///< First frame sync byte
+#define VCNL4020_TELEMETRY_SYNC2 0x5A    ///< Second frame sync byte
+#define VCNL4020_TELEMETRY_HEADER 4      ///< Sync, length and count bytes
+#define VCNL4020_TELEMETRY_OVERHEAD 6    ///< Header plus CRC
+#define VCNL4020_TELEMETRY_SENSORS 8     ///< Sensor ids 0 - 7
+#define VCNL4020_TELEMETRY_ABSOLUTE 0x08 ///< Record flag, no delta encoding
+
+/** One sample as packed by Adafruit_VCNL4020_Telemetry */
+typedef struct {
+  uint32_t timestamp; ///< micros() of the sample
+  uint16_t sequence;  ///< Sample counter, e.g. vcnl4020_record::sequence
+  uint16_t ambient;   ///< Ambient light result
+  uint16_t proximity; ///< Proximity result
+  uint8_t sensor;     ///< Sensor id, 0 - 7, e.g. the mux channel
+} vcnl4020_telemetry_record;
+
+/*!
+ * @brief Packs records into one frame at a time, in a buffer owned by the
+ * caller, so no heap is used. Records of several sensors may be mixed.
+ */
+class Adafruit_VCNL4020_Telemetry {
+public:
+  Adafruit_VCNL4020_Telemetry(uint8_t *buffer, uint16_t size);
+
+  void reset();
+  bool add(const vcnl4020_telemetry_record &record);
+  uint8_t count();
+  uint16_t finish();
+  const uint8_t *frame();
+  size_t send(Print *out);
+
+private:
+  uint8_t *_buffer; ///< Frame being built
+  uint16_t _size;   ///< Room in _buffer, at most 261 bytes are used
+  uint16_t _used;   ///< Bytes of _buffer filled so far
+  uint8_t _count;   ///< Records in the frame
+  uint8_t _seen;    ///< Bit per sensor that has a record in the frame
+  vcnl4020_telemetry_record _last[VCNL4020_TELEMETRY_SENSORS]; ///< Delta bases
+
+  static uint32_t zigzag(int32_t value);
+  static uint8_t putVarint(uint8_t *out, uint32_t value);
+};
+
+#endif // ADAFRUIT_VCNL4020_TELEMETRY_H
@@ -0,0 +1,136 @@
+/*!
+ * @file Adafruit_VCNL4020_Trace.cpp
+ *
+ * Text format for VCNL4020 bus traces.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Trace.h"
+
+/*!
+ * @brief  Prints one event as a trace line, line ending included. Fits a
+ * vcnl4020_bus_tap function.
+ * @param  out    Where to print, e.g. &Serial or an SD card File.
+ * @param  event  The event.
+ * @return The number of characters printed.
+ */
+size_t Adafruit_VCNL4020_Trace::print(Print *out,
+                                      const vcnl4020_bus_event *event) {
+  static const char types[] = {'R', 'W', 'I'};
+  static const char hex[] = "0123456789ABCDEF";
+
+  // Build the line first so it goes out in one write
+  char line[VCNL4020_TRACE_MAX_LINE + 2];
+  uint8_t pos = 0;
+  line[pos++] = types[event->type];
+  line[pos++] = ' ';
+  pos += snprintf(&line[pos], 11, "%lu", (unsigned long)event->timestamp);
+  line[pos++] = ' ';
+  line[pos++] = hex[event->reg >> 4];
+  line[pos++] = hex[event->reg & 0x0F];
+  line[pos++] = ' ';
+  line[pos++] = event->ok ? '1' : '0';
+  if (event->len && event->data) {
+    line[pos++] = ' ';
+    for (uint8_t i = 0; i < event->len && pos + 2 <= VCNL4020_TRACE_MAX_LINE;
+         i++) {
+      line[pos++] = hex[event->data[i] >> 4];
+      line[pos++] = hex[event->data[i] & 0x0F];
+    }
+  }
+  line[pos++] = '\r';
+  line[pos++] = '\n';
+  return out->write((const uint8_t *)line, pos);
+}
+
+/*!
+ * @brief  Parses one trace line.
+ * @param  line   The line, with or without the line ending.
+ * @param  event  Where to store the event. Its data points into data.
+ * @param  data   Where to store the bytes of the event.
+ * @param  size   Room in data.
+ * @return True if the line held an event, false if it is malformed or holds
+ * more than size bytes.
+ */
+bool Adafruit_VCNL4020_Trace::parse(const char *line,
+                                    vcnl4020_bus_event *event, uint8_t *data,
+                                    uint8_t size) {
+  switch (*line++) {
+  case 'R':
+    event->type = VCNL4020_BUS_READ;
+    break;
+  case 'W':
+    event->type = VCNL4020_BUS_WRITE;
+    break;
+  case 'I':
+    event->type = VCNL4020_BUS_INT;
+    break;
+  default:
+    return false;
+  }
+  if (*line++ != ' ' || *line < '0' || *line > '9')
+    return false;
+
+  event->timestamp = 0;
+  while (*line >= '0' && *line <= '9')
+    event->timestamp = event->timestamp * 10 + (*line++ - '0');
+
+  int8_t high, low;
+  if (*line++ != ' ' || (high = hexDigit(line[0])) < 0 ||
+      (low = hexDigit(line[1])) < 0)
+    return false;
+  event->reg = (high << 4) | low;
+  line += 2;
+
+  if (*line++ != ' ' || (*line != '0' && *line != '1'))
+    return false;
+  event->ok = *line++ == '1';
+
+  event->len = 0;
+  event->data = data;
+  if (*line == ' ') {
+    line++;
+    while ((high = hexDigit(line[0])) >= 0 && (low = hexDigit(line[1])) >= 0) {
+      if (event->len == size)
+        return false;
+      data[event->len++] = (high << 4) | low;
+      line += 2;
+    }
+  }
+  return *line == '\0' || *line == '\r' || *line == '\n';
+}
+
+/*!
+ * @brief  Checks that the driver made the transaction a trace recorded: same
+ * type, register and length, and for writes the same bytes. Use in a replay
+ * function to catch a change in what the driver does.
+ * @param  recorded  The event from the trace.
+ * @param  actual    The event the driver made.
+ * @return True if they match.
+ */
+bool Adafruit_VCNL4020_Trace::matches(const vcnl4020_bus_event *recorded,
+                                      const vcnl4020_bus_event *actual) {
+  if (recorded->type != actual->type || recorded->reg != actual->reg ||
+      recorded->len != actual->len)
+    return false;
+  if (actual->type != VCNL4020_BUS_WRITE)
+    return true;
+  return memcmp(recorded->data, actual->data, actual->len) == 0;
+}
+
+/*!
+ * @brief  Converts one hex digit.
+ * @param  c  The character, either case.
+ * @return The value 0 - 15, or -1 if c is not a hex digit.
+ */
+int8_t Adafruit_VCNL4020_Trace::hexDigit(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
@@ -0,0 +1,48 @@
+/*!
+ * @file Adafruit_VCNL4020_Trace.h
+ *
+ * Text format for VCNL4020 bus traces: what Adafruit_VCNL4020::setBusTap()
+ * captures from a live sensor, and what a Adafruit_VCNL4020::setBusReplay()
+ * function feeds back to the driver, so code built on the driver can be
+ * benchmarked and regression tested against recorded sensor output.
+ *
+ * One event per line, fields separated by one space:
+ *
+ *     <type> <timestamp> <reg> <ok> [<data>]
+ *
+ * type is R (read), W (write) or I (INT edge), timestamp is micros() in
+ * decimal, reg is the first register in two hex digits, ok is 1 if the
+ * transaction was acknowledged, else 0, and data is the bytes read or written
+ * as hex digits, e.g. "R 1042877 87 1 01F4". When replaying, hand the
+ * timestamp of the next event to Adafruit_VCNL4020::setClock() so the driver
+ * runs on the captured time.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef ADAFRUIT_VCNL4020_TRACE_H
+#define ADAFRUIT_VCNL4020_TRACE_H
+
+#include "Adafruit_VCNL4020.h"
+
+#define VCNL4020_TRACE_MAX_LINE 52 ///< Longest line, without the line ending
+
+/*!
+ * @brief Prints and parses bus trace lines. Keeps no state, so it works with
+ * whatever the trace is stored on: a serial link, an SD card file or a string
+ * in flash.
+ */
+class Adafruit_VCNL4020_Trace {
+public:
+  static size_t print(Print *out, const vcnl4020_bus_event *event);
+  static bool parse(const char *line, vcnl4020_bus_event *event,
+                    uint8_t *data, uint8_t size);
+  static bool matches(const vcnl4020_bus_event *recorded,
+                      const vcnl4020_bus_event *actual);
+
+private:
+  static int8_t hexDigit(char c);
+};
+
+#endif // ADAFRUIT_VCNL4020_TRACE_H
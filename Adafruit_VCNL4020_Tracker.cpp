@@ -0,0 +1,130 @@
+/*!
+ * @file Adafruit_VCNL4020_Tracker.cpp
+ *
+ * Optional threshold tracking for the VCNL4020.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Tracker.h"
+
+/*!
+ * @brief  Constructs a tracker for a sensor, call start() to start it.
+ * @param  sensor  The sensor, already initialized with begin().
+ */
+Adafruit_VCNL4020_Tracker::Adafruit_VCNL4020_Tracker(
+    Adafruit_VCNL4020 *sensor) {
+  _sensor = sensor;
+  _tracking = false;
+  _baseline = 0;
+  _window = 0;
+  _savedInt = 0;
+}
+
+/*!
+ * @brief  Starts tracking, or re-centres a new window if already tracking.
+ * Ready interrupts are turned off while tracking.
+ * @param  window       Half-width of the window around the baseline.
+ * @param  persistence  How many out-of-window measurements fire INT.
+ * @return True if tracking was started, false on a bus error. If it failed
+ * before the interrupt settings were written, tracking is not started.
+ */
+bool Adafruit_VCNL4020_Tracker::start(uint16_t window,
+                                      vcnl4020_int_count persistence) {
+  VCNL4020_SENSOR_STATS_SCOPE(_sensor, VCNL4020_OP_THRESHOLD_TRACKING);
+
+  if (!_tracking) {
+    if (!_sensor->refreshRegisters())
+      return false;
+    _savedInt = _sensor->getInterruptControl();
+  }
+  _window = window;
+
+  // Only count as tracking once the chip is set up for it, so a failed start
+  // leaves nothing for update() to act on
+  if (!trackBaseline())
+    return false;
+  if (!_sensor->writeInterruptControl(
+          vcnl4020_int_count_field::put(persistence) |
+          vcnl4020_int_thresh_en_field::put(true)))
+    return false;
+  _tracking = true;
+  return _sensor->clearInterruptMask(0x0F);
+}
+
+/*!
+ * @brief  Services tracking, typically after INT fired. Costs one status
+ * read when nothing happened; on an event it acknowledges it, takes the new
+ * reading as the baseline and re-centres the window with one burst write.
+ * @return The VCNL4020_INT_TH_HI / VCNL4020_INT_TH_LOW flags that fired, or 0.
+ */
+uint8_t Adafruit_VCNL4020_Tracker::update() {
+  uint8_t events = 0;
+  update(&events);
+  return events;
+}
+
+/*!
+ * @brief  Services tracking like update(), telling bus errors apart from no
+ * events.
+ * @param  events  Where to store the VCNL4020_INT_TH_HI / VCNL4020_INT_TH_LOW
+ * flags that fired, 0 if none or if tracking is not active. Untouched if the
+ * status could not be read and acknowledged.
+ * @return True if the status was serviced and, after an event, the window
+ * re-centred. False if the status read or acknowledge failed (the flags stay
+ * pending) or if re-centring the window failed.
+ */
+bool Adafruit_VCNL4020_Tracker::update(uint8_t *events) {
+  VCNL4020_SENSOR_STATS_SCOPE(_sensor, VCNL4020_OP_THRESHOLD_TRACKING);
+
+  uint8_t status = 0;
+  if (_tracking && !_sensor->readAndClearInterrupts(&status))
+    return false;
+  *events = status & (VCNL4020_INT_TH_HI | VCNL4020_INT_TH_LOW);
+  return *events == 0 || trackBaseline();
+}
+
+/*!
+ * @brief  Stops tracking and restores the interrupt settings that were
+ * active before it started. The thresholds are left as they are.
+ * @return True if tracking is off and the interrupt settings were restored,
+ * false if the write failed, in which case tracking stays on so the call can
+ * be repeated.
+ */
+bool Adafruit_VCNL4020_Tracker::stop() {
+  VCNL4020_SENSOR_STATS_SCOPE(_sensor, VCNL4020_OP_THRESHOLD_TRACKING);
+
+  if (!_tracking)
+    return true;
+  if (!_sensor->writeInterruptControl(_savedInt))
+    return false;
+  _tracking = false;
+  return true;
+}
+
+/*!
+ * @brief  Gets the proximity reading the threshold window is centred on.
+ * @return The baseline of threshold tracking.
+ */
+uint16_t Adafruit_VCNL4020_Tracker::getBaseline() { return _baseline; }
+
+/*!
+ * @brief  Reads the current proximity as the new baseline and centres the
+ * threshold window on it.
+ * @return True if the thresholds were written.
+ */
+bool Adafruit_VCNL4020_Tracker::trackBaseline() {
+  uint8_t buffer[2];
+  if (!_sensor->busRead(VCNL4020_REG_PROX_RESULT_HIGH, buffer, 2))
+    return false;
+  uint16_t proximity = ((uint16_t)buffer[0] << 8) | buffer[1];
+  if (proximity == 0xFFFF) // spurious, keep the old window
+    return true;
+
+  _baseline = proximity;
+  uint16_t low = (_baseline > _window) ? _baseline - _window : 0;
+  uint16_t high =
+      (0xFFFF - _baseline > _window) ? _baseline + _window : 0xFFFF;
+  return _sensor->setThresholds(low, high);
+}
@@ -0,0 +1,43 @@
+/*!
+ * @file Adafruit_VCNL4020_Tracker.h
+ *
+ * Optional threshold tracking for the VCNL4020: keeps a threshold window
+ * centred on the proximity baseline so INT only fires when something moves.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef ADAFRUIT_VCNL4020_TRACKER_H
+#define ADAFRUIT_VCNL4020_TRACKER_H
+
+#include "Adafruit_VCNL4020.h"
+
+/*!
+ * @brief Moves proximity event detection onto the sensor: takes the current
+ * reading as a baseline, programs a threshold window around it and makes INT
+ * fire only when the reading leaves that window for a number of measurements
+ * in a row. The MCU can sleep until then and call update(), which re-centres
+ * the window on the new reading.
+ */
+class Adafruit_VCNL4020_Tracker {
+public:
+  Adafruit_VCNL4020_Tracker(Adafruit_VCNL4020 *sensor);
+
+  bool start(uint16_t window, vcnl4020_int_count persistence = INT_COUNT_4);
+  uint8_t update();
+  bool update(uint8_t *events);
+  bool stop();
+  uint16_t getBaseline();
+
+private:
+  Adafruit_VCNL4020 *_sensor; ///< The sensor being tracked
+  bool _tracking;             ///< True while tracking is active
+  uint16_t _baseline;         ///< Proximity the threshold window is centred on
+  uint16_t _window;           ///< Half-width of the threshold window
+  uint8_t _savedInt;          ///< INT control to restore when tracking stops
+
+  bool trackBaseline();
+};
+
+#endif // ADAFRUIT_VCNL4020_TRACKER_H
@@ -0,0 +1,124 @@
+#include <Wire.h>
+#include "Adafruit_VCNL4020.h"
+
+// Bus cost benchmark: runs the driver's hot paths and prints how many I2C
+// transactions and bytes each one takes, plus the bus time that traffic
+// would need at 100 kHz, 400 kHz and 1 MHz. Handy for budgeting a shared
+// bus and for spotting regressions in bus cost.
+//
+// The counters are compiled in only when VCNL4020_ENABLE_STATS is defined
+// for the library, either by uncommenting it in Adafruit_VCNL4020.h or by
+// passing -DVCNL4020_ENABLE_STATS in your build flags.
+//
+// 'make -C extras/host bench' runs the same workload against the chip
+// simulator and prints the transactions, bytes and modeled bus time without
+// a board.
+
+#define ITERATIONS 100
+
+Adafruit_VCNL4020 vcnl4020;
+
+#ifdef VCNL4020_ENABLE_STATS
+// Modeled time for the counted traffic: 9 clocks per byte (8 data + ACK),
+// the device address once per write and twice per read (repeated start),
+// and roughly 2 clocks of start/stop per transaction
+float modeledMicros(const vcnl4020_stats &stats, uint32_t clock) {
+  uint32_t transactions = stats.reads + stats.writes;
+  uint32_t bytes = stats.bytes + stats.writes + 2 * stats.reads;
+  uint32_t clocks = 9 * bytes + 2 * transactions;
+  return clocks * 1000000.0 / clock;
+}
+
+void report(const char *name, uint32_t count) {
+  vcnl4020_stats stats = vcnl4020.getStats();
+
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print((float)(stats.reads + stats.writes) / count);
+  Serial.print(" xfers, ");
+  Serial.print((float)stats.bytes / count);
+  Serial.print(" bytes, measured ");
+  Serial.print((float)stats.busMicros / count);
+  Serial.print(" us; modeled us @100k/400k/1M: ");
+  Serial.print(modeledMicros(stats, 100000) / count);
+  Serial.print(" / ");
+  Serial.print(modeledMicros(stats, 400000) / count);
+  Serial.print(" / ");
+  Serial.println(modeledMicros(stats, 1000000) / count);
+
+  vcnl4020.resetStats();
+}
+#endif
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(10); // wait for serial port to start.
+
+  Serial.println("Adafruit VCNL4020 Bus Cost Benchmark");
+
+#ifndef VCNL4020_ENABLE_STATS
+  Serial.println("Define VCNL4020_ENABLE_STATS for the library to run this!");
+  while (1) delay(10);
+#else
+  Wire.begin();
+  Wire.setClock(400000);
+
+  vcnl4020.resetStats();
+  if (!vcnl4020.begin(&Wire)) {
+    Serial.println("Failed to initialize VCNL4020!");
+    while (1);
+  }
+  report("begin()", 1);
+
+  for (uint16_t i = 0; i < ITERATIONS; i++)
+    vcnl4020.readProximity();
+  report("readProximity()", ITERATIONS);
+
+  for (uint16_t i = 0; i < ITERATIONS; i++)
+    vcnl4020.readAmbient();
+  report("readAmbient()", ITERATIONS);
+
+  vcnl4020_sample sample;
+  for (uint16_t i = 0; i < ITERATIONS; i++)
+    vcnl4020.readSample(&sample);
+  report("readSample()", ITERATIONS);
+
+  // The vcnl4020_proxplotter loop: poll, read, clear
+  uint16_t done = 0;
+  while (done < ITERATIONS) {
+    if (vcnl4020.isProxReady()) {
+      vcnl4020.readProximity();
+      vcnl4020.clearInterrupts(true, false, false, false);
+      done++;
+    }
+  }
+  report("proxplotter loop, per sample", ITERATIONS);
+
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    vcnl4020.setProxRate(PROX_RATE_250_PER_S);
+    vcnl4020.setProxLEDmA(200);
+    vcnl4020.setAmbientRate(AMBIENT_RATE_10_SPS);
+    vcnl4020.setAmbientAveraging(AVG_1_SAMPLES);
+    vcnl4020.setProxFrequency(PROX_FREQ_390_625_KHZ);
+    vcnl4020.setLowThreshold(0);
+    vcnl4020.setHighThreshold(0);
+  }
+  report("seven config setters", ITERATIONS);
+
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    vcnl4020.setInterruptConfig(true, true, false, false, INT_COUNT_1);
+  }
+  report("setInterruptConfig()", ITERATIONS);
+
+  vcnl4020_config config;
+  Adafruit_VCNL4020::getDefaultConfig(&config);
+  config.proxRate = PROX_RATE_125_PER_S;
+  config.highThreshold = 1000;
+  vcnl4020.applyConfig(&config);
+  report("applyConfig(), two changes", 1);
+
+  Serial.println("Done.");
+#endif
+}
+
+void loop() {}
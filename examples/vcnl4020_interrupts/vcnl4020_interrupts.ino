@@ -0,0 +1,61 @@
+#include <Wire.h>
+#include "Adafruit_VCNL4020.h"
+
+// This example uses the INT pin instead of polling isProxReady(). The
+// interrupt handler only notes the time, the I2C read happens in loop()
+// and lands in a small ring buffer that can be drained in batches.
+
+#define VCNL4020_INT_PIN 2 // must be a pin that supports attachInterrupt()
+
+Adafruit_VCNL4020 vcnl4020;
+Adafruit_VCNL4020_SampleBuffer<16> samples;
+
+void vcnl4020ISR() {
+  vcnl4020.handleInterrupt();
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(10); // wait for serial port to start.
+
+  Serial.println("Adafruit VCNL4020 Interrupt Test Sketch");
+
+  // Initialize sensor, the defaults already fire INT on prox and ALS ready
+  if (!vcnl4020.begin(&Wire)) {
+    Serial.println("Failed to initialize VCNL4020!");
+    while (1);
+  }
+  Serial.println("VCNL4020 initialized.");
+
+  // INT is open drain and active low
+  pinMode(VCNL4020_INT_PIN, INPUT_PULLUP);
+  vcnl4020.setInterruptPin(VCNL4020_INT_PIN);
+  attachInterrupt(digitalPinToInterrupt(VCNL4020_INT_PIN), vcnl4020ISR, FALLING);
+}
+
+void loop() {
+  // Fetch whatever the INT pin announced
+  vcnl4020.serviceInterrupt(&samples);
+
+  // Drain the buffer a few samples at a time
+  vcnl4020_timed_sample batch[4];
+  uint8_t n = samples.read(batch, 4);
+  for (uint8_t i = 0; i < n; i++) {
+    Serial.print(batch[i].timestamp);
+    if (batch[i].status & VCNL4020_INT_PROX_READY) {
+      Serial.print(" Prox: ");
+      Serial.print(batch[i].proximity);
+    }
+    if (batch[i].status & VCNL4020_INT_ALS_READY) {
+      Serial.print(" Ambient: ");
+      Serial.print(batch[i].ambient);
+    }
+    Serial.println();
+  }
+
+  if (samples.overflows()) {
+    Serial.print("Dropped samples: ");
+    Serial.println(samples.overflows());
+    samples.clearOverflows();
+  }
+}
@@ -0,0 +1,37 @@
+#include <Wire.h>
+#include "Adafruit_VCNL4020_Array.h"
+
+// The VCNL4020 address is fixed, so to use several of them put each one on
+// its own channel of a TCA9548A I2C multiplexer. Here there are three
+// sensors, on mux channels 0, 1 and 2.
+
+const uint8_t channels[] = {0, 1, 2};
+Adafruit_VCNL4020_Array<3> sensors;
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(10); // wait for serial port to start.
+
+  Serial.println("Adafruit VCNL4020 Multiplexer Test Sketch");
+
+  if (!sensors.begin(channels, &Wire)) {
+    Serial.println("Failed to initialize the mux or a VCNL4020!");
+    while (1);
+  }
+  Serial.println("All VCNL4020s initialized.");
+}
+
+void loop() {
+  vcnl4020_array_reading frame[3];
+  sensors.readFrame(frame);
+
+  for (uint8_t i = 0; i < 3; i++) {
+    Serial.print("Prox");
+    Serial.print(i);
+    Serial.print(":");
+    Serial.print(frame[i].proximity);
+    Serial.print(" ");
+  }
+  Serial.println();
+  delay(50);
+}
@@ -1,9 +1,11 @@
 #include <Wire.h>
 #include "Adafruit_VCNL4020.h"
+#include "Adafruit_VCNL4020_ProxStream.h"
 
 // This example is pared down specifically to make it easier to test using the serial plotter
 
 Adafruit_VCNL4020 vcnl4020;
+Adafruit_VCNL4020_ProxStream stream(&vcnl4020);
 
 void setup() {
   Serial.begin(115200);
@@ -42,21 +44,16 @@ void setup() {
   vcnl4020.enable(false /* ALS Enable */, true /* Proximity Enable */, true /* Self-Timed Enable */);
   // dont use on-demand, we will have continuous reads.
   vcnl4020.setOnDemand(false /* ALS on demand read */, false /* Prox on demand read */);
+
+  // stream samples paced by the proximity rate, instead of polling for each
+  stream.start();
 }
 
 void loop() {
-  if (vcnl4020.isProxReady()) {
-    uint16_t p = vcnl4020.readProximity();
-    if (p != 0xFFFF) {  // ignore spurious readings
-      Serial.print("Prox: ");
-      Serial.println(p);
-      
-    }
-    vcnl4020.clearInterrupts( // Clear Interrupts
-      true /* Proximity Ready */, 
-      false /* ALS Ready */, 
-      false /* Threshold Low */, 
-      false /* Threshold High */
-    );
+  uint16_t p;
+  // spurious 0xFFFF readings are filtered out by the stream
+  if (stream.next(&p)) {
+    Serial.print("Prox: ");
+    Serial.println(p);
   }
 }
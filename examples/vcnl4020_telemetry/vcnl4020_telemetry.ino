@@ -0,0 +1,47 @@
+#include <Wire.h>
+#include "Adafruit_VCNL4020.h"
+#include "Adafruit_VCNL4020_Recorder.h"
+#include "Adafruit_VCNL4020_Telemetry.h"
+
+// Streams proximity and ambient samples as compact binary frames instead of
+// text, for rates where printing "Prox: <n>" costs more than the I2C reads.
+// Decode on the computer with extras/vcnl4020_telemetry_decode.py, e.g.
+//   cat /dev/ttyACM0 | python3 vcnl4020_telemetry_decode.py
+// Don't open the Serial Monitor, it's binary!
+
+Adafruit_VCNL4020 vcnl4020;
+Adafruit_VCNL4020_Recorder recorder(&vcnl4020);
+
+uint8_t frameBuffer[128];
+Adafruit_VCNL4020_Telemetry telemetry(frameBuffer, sizeof(frameBuffer));
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(10); // wait for serial port to start.
+
+  if (!vcnl4020.begin(&Wire)) {
+    while (1);
+  }
+
+  // Fastest proximity rate, ambient light keeps its own slower rate
+  vcnl4020.setProxRate(PROX_RATE_250_PER_S);
+}
+
+void loop() {
+  vcnl4020_record ambient, proximity;
+  if (!recorder.read(&ambient, &proximity) || !proximity.fresh)
+    return;
+
+  vcnl4020_telemetry_record record;
+  record.sensor = 0;
+  record.sequence = proximity.sequence;
+  record.timestamp = proximity.timestamp;
+  record.ambient = ambient.value;
+  record.proximity = proximity.value;
+
+  // Send when the frame is full, many samples per write
+  if (!telemetry.add(record)) {
+    telemetry.send(&Serial);
+    telemetry.add(record);
+  }
+}
@@ -0,0 +1,113 @@
+#include <Wire.h>
+#include "Adafruit_VCNL4020.h"
+#include "Adafruit_VCNL4020_ProxStream.h"
+#include "Adafruit_VCNL4020_Trace.h"
+
+// Captures everything the driver does on the bus to a trace, then replays
+// the trace through the driver instead of the sensor, so the same input can
+// be run again and again while tuning the filter below.
+//
+// 1. With REPLAY set to 0, capture: save the Serial output to a file, e.g.
+//      cat /dev/ttyACM0 > prox.trace
+//    Lines starting with # are this sketch's own output, not trace.
+// 2. With REPLAY set to 1, send the file back and watch the filtered output,
+//      cat prox.trace > /dev/ttyACM0
+//    Any transaction that differs from the trace is counted as a mismatch.
+//    The driver takes its time from the trace too, so pacing, drop counts
+//    and timestamps come out as they did during the capture.
+#define REPLAY 0
+
+Adafruit_VCNL4020 vcnl4020;
+Adafruit_VCNL4020_ProxStream stream(&vcnl4020);
+Adafruit_VCNL4020_Filter filter(VCNL4020_FILTER_MEDIAN, 5);
+
+#if REPLAY
+char line[VCNL4020_TRACE_MAX_LINE + 3];
+uint8_t lineData[16];
+vcnl4020_bus_event nextEvent;
+bool haveEvent = false;
+uint32_t mismatches = 0;
+
+// Reads trace lines until one parses, skipping the sketch's own output
+void loadNext() {
+  haveEvent = false;
+  while (!haveEvent) {
+    size_t len = Serial.readBytesUntil('\n', line, sizeof(line) - 1);
+    if (len == 0)
+      return; // end of trace
+    line[len] = 0;
+    haveEvent = Adafruit_VCNL4020_Trace::parse(line, &nextEvent, lineData,
+                                               sizeof(lineData));
+  }
+}
+
+// Answers the driver from the trace instead of the sensor
+bool replayBus(const vcnl4020_bus_event *event, uint8_t *readData) {
+  if (!haveEvent || !Adafruit_VCNL4020_Trace::matches(&nextEvent, event)) {
+    mismatches++;
+    return false;
+  }
+  if (readData)
+    memcpy(readData, nextEvent.data, event->len);
+  bool ok = nextEvent.ok;
+  loadNext();
+  return ok;
+}
+
+// Replayed time: when the next transaction in the trace happened
+uint32_t replayClock() {
+  return nextEvent.timestamp;
+}
+#else
+// Prints every transaction and serviced INT edge as a trace line
+void captureBus(const vcnl4020_bus_event *event) {
+  Adafruit_VCNL4020_Trace::print(&Serial, event);
+}
+#endif
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(10); // wait for serial port to start.
+
+  Serial.println("# Adafruit VCNL4020 Trace Sketch");
+
+#if REPLAY
+  Serial.setTimeout(2000);
+  loadNext();
+  vcnl4020.setBusReplay(replayBus);
+  vcnl4020.setClock(replayClock);
+  // begin() would probe the real bus first
+  if (!vcnl4020.fastBegin()) {
+#else
+  vcnl4020.setBusTap(captureBus);
+  if (!vcnl4020.begin(&Wire)) {
+#endif
+    Serial.println("# Failed to initialize VCNL4020!");
+    while (1);
+  }
+
+  vcnl4020.enable(false, true, true);
+  vcnl4020.setProxFilter(&filter);
+  stream.start();
+}
+
+void loop() {
+#if REPLAY
+  if (!haveEvent) {
+    Serial.print("# End of trace, mismatches: ");
+    Serial.println(mismatches);
+    while (1);
+  }
+  // INT edges in the trace happened before the call that serviced them
+  while (haveEvent && nextEvent.type == VCNL4020_BUS_INT) {
+    vcnl4020.handleInterrupt(nextEvent.timestamp);
+    loadNext();
+  }
+#endif
+
+  uint16_t p;
+  if (stream.next(&p)) {
+    Serial.print("# Prox: ");
+    Serial.println(p);
+  }
+}
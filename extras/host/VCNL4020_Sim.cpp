@@ -0,0 +1,379 @@
+/*!
+ * @file VCNL4020_Sim.cpp
+ *
+ * Register-level VCNL4020 simulator for host tests.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "VCNL4020_Sim.h"
+
+// Register #0 bits
+#define SIM_SELFTIMED_EN 0x01
+#define SIM_PROX_EN 0x02
+#define SIM_ALS_EN 0x04
+#define SIM_PROX_OD 0x08
+#define SIM_ALS_OD 0x10
+#define SIM_PROX_RDY 0x20
+#define SIM_ALS_RDY 0x40
+#define SIM_CONFIG_LOCK 0x80
+
+// Register #9 bits
+#define SIM_THRESH_ALS 0x01
+#define SIM_THRESH_EN 0x02
+#define SIM_ALS_READY_EN 0x04
+#define SIM_PROX_READY_EN 0x08
+
+// Register #14 bits
+#define SIM_TH_HI 0x01
+#define SIM_TH_LOW 0x02
+#define SIM_ALS_READY 0x04
+#define SIM_PROX_READY 0x08
+
+/*!
+ * @brief  Puts a simulated chip on the host bus, in its power-on state.
+ * @param  addr  The 7-bit address.
+ */
+VCNL4020_Sim::VCNL4020_Sim(uint8_t addr) {
+  _addr = addr;
+  _intPin = -1;
+  _ambient = 0;
+  _proximity = 0;
+  present = true;
+  failReads = 0;
+  failWrites = 0;
+  passWrites = 0;
+  resetCounters();
+  powerOnReset();
+  hostAttachTarget(_addr, this);
+}
+
+VCNL4020_Sim::~VCNL4020_Sim() { hostAttachTarget(_addr, NULL); }
+
+/*!
+ * @brief  Brings the registers back to their power-on values and stops all
+ * conversions, as a brown-out would.
+ */
+void VCNL4020_Sim::powerOnReset() {
+  static const uint8_t defaults[16] = {SIM_CONFIG_LOCK, 0x21, 0x00, 0x02,
+                                       0x1D, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                       0x01};
+  memcpy(_regs, defaults, sizeof(_regs));
+  _pointer = 0x80;
+  _proxRunning = false;
+  _alsRunning = false;
+  _proxSelfTimed = false;
+  _alsSelfTimed = false;
+  _outside = 0;
+  updatePin();
+}
+
+/*!
+ * @brief  Sets what later ALS conversions measure.
+ * @param  counts  The ambient result.
+ */
+void VCNL4020_Sim::setAmbient(uint16_t counts) { _ambient = counts; }
+
+/*!
+ * @brief  Sets what later proximity conversions measure.
+ * @param  counts  The proximity result.
+ */
+void VCNL4020_Sim::setProximity(uint16_t counts) { _proximity = counts; }
+
+/*!
+ * @brief  Connects INT to a host pin, see hostWritePin().
+ * @param  pin  The pin, -1 for none.
+ */
+void VCNL4020_Sim::setIntPin(int pin) {
+  _intPin = pin;
+  updatePin();
+}
+
+/*!
+ * @brief  Reads a register without a bus transaction.
+ * @param  reg  The address, 0x80 - 0x8F.
+ * @return The value.
+ */
+uint8_t VCNL4020_Sim::peek(uint8_t reg) {
+  run();
+  return _regs[reg & 0x0F];
+}
+
+/*!
+ * @brief  Sets a register without a bus transaction or side effects.
+ * @param  reg    The address, 0x80 - 0x8F.
+ * @param  value  The value.
+ */
+void VCNL4020_Sim::poke(uint8_t reg, uint8_t value) {
+  _regs[reg & 0x0F] = value;
+  updatePin();
+}
+
+/*!
+ * @brief  Runs the conversions due by now, so INT edges happen without bus
+ * traffic. Call after hostAdvance().
+ */
+void VCNL4020_Sim::tick() { run(); }
+
+/*!
+ * @brief  Zeroes the transaction and conversion counters.
+ */
+void VCNL4020_Sim::resetCounters() {
+  reads = 0;
+  writes = 0;
+  bytes = 0;
+  proxConversions = 0;
+  alsConversions = 0;
+}
+
+bool VCNL4020_Sim::i2cWrite(const uint8_t *data, size_t len) {
+  if (!present)
+    return false;
+  if (!data || !len)
+    return true; // address probe
+  if (passWrites) {
+    passWrites--;
+  } else if (failWrites) {
+    failWrites--;
+    return false;
+  }
+  run();
+
+  // A lone register address only sets the pointer for the read that follows
+  bytes += len;
+  if (len > 1)
+    writes++;
+
+  _pointer = data[0];
+  for (size_t i = 1; i < len; i++, _pointer++) {
+    if (_pointer < 0x80 || _pointer > 0x8F)
+      continue;
+    uint8_t index = _pointer & 0x0F;
+    uint8_t value = data[i];
+    switch (index) {
+    case 0:
+      writeCommand(value);
+      break;
+    case 2:
+      _regs[index] = value & 0x07;
+      break;
+    case 3:
+      _regs[index] = value & 0x3F;
+      break;
+    case 14:
+      _regs[index] &= ~value;
+      break;
+    case 1:
+    case 5:
+    case 6:
+    case 7:
+    case 8:
+      break; // read-only
+    default:
+      _regs[index] = value;
+      break;
+    }
+  }
+  updatePin();
+  return true;
+}
+
+bool VCNL4020_Sim::i2cRead(uint8_t *data, size_t len) {
+  if (!present)
+    return false;
+  if (failReads) {
+    failReads--;
+    return false;
+  }
+  run();
+  reads++;
+  bytes += len;
+
+  uint8_t cleared = 0;
+  for (size_t i = 0; i < len; i++, _pointer++) {
+    if (_pointer < 0x80 || _pointer > 0x8F) {
+      data[i] = 0;
+      continue;
+    }
+    uint8_t index = _pointer & 0x0F;
+    data[i] = _regs[index];
+    if (index == 5 || index == 6)
+      cleared |= SIM_ALS_RDY;
+    if (index == 7 || index == 8)
+      cleared |= SIM_PROX_RDY;
+  }
+
+  // Reading a result clears its data ready bit
+  _regs[0] &= ~cleared;
+  return true;
+}
+
+/*!
+ * @brief  Completes every conversion due by micros(), in time order.
+ */
+void VCNL4020_Sim::run() {
+  uint32_t now = micros();
+  while (true) {
+    bool prox = _proxRunning && (int32_t)(now - _proxDue) >= 0;
+    bool als = _alsRunning && (int32_t)(now - _alsDue) >= 0;
+    if (prox && als) {
+      if ((int32_t)(_proxDue - _alsDue) <= 0)
+        als = false;
+      else
+        prox = false;
+    }
+
+    if (prox) {
+      uint32_t when = _proxDue;
+      completeProx();
+      _proxRunning = _proxSelfTimed;
+      _proxDue = when + proxPeriod();
+      // A running ALS conversion holds the next proximity conversion up
+      if (_alsRunning &&
+          (int32_t)(_proxDue - (_alsDue - alsMicros())) >= 0 &&
+          (int32_t)(_proxDue - _alsDue) < 0)
+        _proxDue = _alsDue + VCNL4020_SIM_PROX_MICROS;
+    } else if (als) {
+      uint32_t when = _alsDue;
+      completeAls();
+      _alsRunning = _alsSelfTimed;
+      _alsDue = when + ((_regs[4] & 0x80) ? alsMicros() : alsPeriod());
+    } else {
+      break;
+    }
+  }
+  updatePin();
+}
+
+/*!
+ * @brief  Handles a write to register #0: enables, self-timed mode and the
+ * on-demand triggers, which the chip ignores while self-timed mode is on.
+ * @param  value  The value written.
+ */
+void VCNL4020_Sim::writeCommand(uint8_t value) {
+  uint32_t now = micros();
+  bool selfTimed = value & SIM_SELFTIMED_EN;
+  bool proxSelfTimed = selfTimed && (value & SIM_PROX_EN);
+  bool alsSelfTimed = selfTimed && (value & SIM_ALS_EN);
+
+  if (proxSelfTimed && !_proxSelfTimed) {
+    _proxRunning = true;
+    _proxDue = now + VCNL4020_SIM_PROX_MICROS;
+  } else if (!proxSelfTimed && _proxSelfTimed) {
+    _proxRunning = false;
+  }
+  if (alsSelfTimed && !_alsSelfTimed) {
+    _alsRunning = true;
+    _alsDue = now + alsMicros();
+  } else if (!alsSelfTimed && _alsSelfTimed) {
+    _alsRunning = false;
+  }
+  _proxSelfTimed = proxSelfTimed;
+  _alsSelfTimed = alsSelfTimed;
+
+  // An on-demand pair converts ALS first, then proximity
+  if (!selfTimed && (value & SIM_ALS_OD) && !_alsRunning) {
+    _alsRunning = true;
+    _alsDue = now + alsMicros();
+  }
+  if (!selfTimed && (value & SIM_PROX_OD) && !_proxRunning) {
+    _proxRunning = true;
+    _proxDue = now + VCNL4020_SIM_PROX_MICROS;
+    if (value & SIM_ALS_OD)
+      _proxDue += alsMicros();
+  }
+
+  uint8_t od = 0;
+  if (_alsRunning && !_alsSelfTimed)
+    od |= SIM_ALS_OD;
+  if (_proxRunning && !_proxSelfTimed)
+    od |= SIM_PROX_OD;
+  _regs[0] = SIM_CONFIG_LOCK | (_regs[0] & (SIM_PROX_RDY | SIM_ALS_RDY)) |
+             od | (value & (SIM_ALS_EN | SIM_PROX_EN | SIM_SELFTIMED_EN));
+}
+
+/*!
+ * @brief  Finishes a proximity conversion.
+ */
+void VCNL4020_Sim::completeProx() {
+  _regs[7] = _proximity >> 8;
+  _regs[8] = _proximity & 0xFF;
+  _regs[0] = (_regs[0] & ~SIM_PROX_OD) | SIM_PROX_RDY;
+  if (_regs[9] & SIM_PROX_READY_EN)
+    _regs[14] |= SIM_PROX_READY;
+  threshold(false, _proximity);
+  proxConversions++;
+}
+
+/*!
+ * @brief  Finishes an ALS conversion.
+ */
+void VCNL4020_Sim::completeAls() {
+  _regs[5] = _ambient >> 8;
+  _regs[6] = _ambient & 0xFF;
+  _regs[0] = (_regs[0] & ~SIM_ALS_OD) | SIM_ALS_RDY;
+  if (_regs[9] & SIM_ALS_READY_EN)
+    _regs[14] |= SIM_ALS_READY;
+  threshold(true, _ambient);
+  alsConversions++;
+}
+
+/*!
+ * @brief  Checks a result against the threshold window, raising TH_HI or
+ * TH_LOW once INT_COUNT results in a row fall outside it.
+ * @param  als    True for an ALS result, false for proximity.
+ * @param  value  The result.
+ */
+void VCNL4020_Sim::threshold(bool als, uint16_t value) {
+  uint8_t control = _regs[9];
+  if (!(control & SIM_THRESH_EN) || ((control & SIM_THRESH_ALS) != 0) != als)
+    return;
+
+  uint16_t low = ((uint16_t)_regs[10] << 8) | _regs[11];
+  uint16_t high = ((uint16_t)_regs[12] << 8) | _regs[13];
+  if (value >= low && value <= high) {
+    _outside = 0;
+    return;
+  }
+  if (_outside < 255)
+    _outside++;
+  if (_outside >= (1 << (control >> 5)))
+    _regs[14] |= (value > high) ? SIM_TH_HI : SIM_TH_LOW;
+}
+
+/*!
+ * @brief  Drives INT low while any interrupt status flag is set.
+ */
+void VCNL4020_Sim::updatePin() {
+  if (_intPin >= 0)
+    hostWritePin(_intPin, (_regs[14] & 0x0F) ? LOW : HIGH);
+}
+
+/*!
+ * @brief  Gets how long one ALS conversion takes with the current averaging.
+ * @return The time in microseconds.
+ */
+uint32_t VCNL4020_Sim::alsMicros() {
+  return (uint32_t)VCNL4020_SIM_ALS_MICROS << (_regs[4] & 0x07);
+}
+
+/*!
+ * @brief  Gets the self-timed proximity period of register #2.
+ * @return The period in microseconds.
+ */
+uint32_t VCNL4020_Sim::proxPeriod() {
+  static const uint32_t periods[] = {512821, 256000, 128000, 60150,
+                                     32000,  16000,  8000,   4000};
+  return periods[_regs[2] & 0x07];
+}
+
+/*!
+ * @brief  Gets the self-timed ALS period of register #4.
+ * @return The period in microseconds.
+ */
+uint32_t VCNL4020_Sim::alsPeriod() {
+  static const uint32_t periods[] = {1000000, 500000, 333333, 250000,
+                                     200000,  166667, 125000, 100000};
+  return periods[(_regs[4] >> 4) & 0x07];
+}
@@ -0,0 +1,77 @@
+/*!
+ * @file VCNL4020_Sim.h
+ *
+ * Register-level VCNL4020 simulator for host tests. Models the register map
+ * and its power-on values, auto-incrementing reads and writes, on-demand and
+ * self-timed conversions on the simulated clock (an ALS conversion holds up
+ * proximity), data ready bits cleared by reading the results, the
+ * write-1-to-clear interrupt status with the threshold persistence count, and
+ * the active-low INT pin. Bus errors and brown-outs can be injected.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef VCNL4020_SIM_H
+#define VCNL4020_SIM_H
+
+#include "Adafruit_I2CDevice.h"
+
+#define VCNL4020_SIM_PROX_MICROS 400 ///< Proximity conversion time
+#define VCNL4020_SIM_ALS_MICROS 900  ///< Per averaged ALS conversion
+
+/** A VCNL4020 on the host I2C bus */
+class VCNL4020_Sim : public HostI2CTarget {
+public:
+  VCNL4020_Sim(uint8_t addr = 0x13);
+  ~VCNL4020_Sim();
+
+  void powerOnReset();
+  void setAmbient(uint16_t counts);
+  void setProximity(uint16_t counts);
+  void setIntPin(int pin);
+  uint8_t peek(uint8_t reg);
+  void poke(uint8_t reg, uint8_t value);
+  void tick();
+  void resetCounters();
+
+  bool i2cWrite(const uint8_t *data, size_t len);
+  bool i2cRead(uint8_t *data, size_t len);
+
+  bool present;             ///< False to NACK everything
+  uint16_t failReads;       ///< NACK this many of the next reads
+  uint16_t failWrites;      ///< NACK this many of the next writes
+  uint16_t passWrites;      ///< Writes to acknowledge before failWrites
+  uint32_t reads;           ///< Acknowledged read transactions
+  uint32_t writes;          ///< Acknowledged writes, address probes excluded
+  uint32_t bytes;           ///< Bytes moved, register addresses included
+  uint32_t proxConversions; ///< Proximity conversions completed
+  uint32_t alsConversions;  ///< ALS conversions completed
+
+private:
+  uint8_t _addr;       ///< Bus address
+  uint8_t _regs[16];   ///< Registers #0 through #15
+  uint8_t _pointer;    ///< Register the next access starts at
+  uint16_t _ambient;   ///< Value the next ALS conversion gives
+  uint16_t _proximity; ///< Value the next proximity conversion gives
+  int _intPin;         ///< Pin driven by INT, -1 for none
+  uint32_t _proxDue;   ///< micros() the next proximity result is due
+  uint32_t _alsDue;    ///< micros() the next ALS result is due
+  bool _proxRunning;   ///< A proximity conversion is scheduled
+  bool _alsRunning;    ///< An ALS conversion is scheduled
+  bool _proxSelfTimed; ///< The scheduled proximity conversion repeats
+  bool _alsSelfTimed;  ///< The scheduled ALS conversion repeats
+  uint8_t _outside;    ///< Conversions in a row outside the thresholds
+
+  void run();
+  void writeCommand(uint8_t value);
+  void completeProx();
+  void completeAls();
+  void threshold(bool als, uint16_t value);
+  void updatePin();
+  uint32_t alsMicros();
+  uint32_t proxPeriod();
+  uint32_t alsPeriod();
+};
+
+#endif // VCNL4020_SIM_H
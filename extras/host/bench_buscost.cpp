@@ -0,0 +1,110 @@
+/*!
+ * @file bench_buscost.cpp
+ *
+ * Host run of the vcnl4020_buscost example workload against the chip
+ * simulator. Prints the I2C transactions, bytes and modeled bus time of each
+ * driver call, so a change in bus cost shows up in the build log.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020.h"
+#include "VCNL4020_Sim.h"
+#include <stdio.h>
+
+#define ITERATIONS 100 ///< Calls per row, as in the example
+
+static VCNL4020_Sim *sim; ///< The simulated chip, counts the traffic
+
+/*!
+ * @brief  Modeled bus time for the counted traffic: 9 clocks per byte (8 data
+ * + ACK), the device address once per write and twice per read (repeated
+ * start), and roughly 2 clocks of start/stop per transaction.
+ * @param  clock  The bus clock in Hz.
+ * @return The bus time in microseconds.
+ */
+static float modeledMicros(uint32_t clock) {
+  uint32_t transactions = sim->reads + sim->writes;
+  uint32_t bytes = sim->bytes + sim->writes + 2 * sim->reads;
+  uint32_t clocks = 9 * bytes + 2 * transactions;
+  return clocks * 1000000.0f / clock;
+}
+
+/*!
+ * @brief  Prints one row per call and resets the counters.
+ * @param  name   What was run.
+ * @param  count  How many times it was run.
+ */
+static void report(const char *name, uint32_t count) {
+  printf("%-30s %7.2f %7.2f %9.1f %8.1f %8.1f\n", name,
+         (float)(sim->reads + sim->writes) / count, (float)sim->bytes / count,
+         modeledMicros(100000) / count, modeledMicros(400000) / count,
+         modeledMicros(1000000) / count);
+  sim->resetCounters();
+}
+
+int main() {
+  hostReset();
+  VCNL4020_Sim chip;
+  sim = &chip;
+  Adafruit_VCNL4020 vcnl4020;
+
+  printf("%-30s %7s %7s %9s %8s %8s\n", "per call", "xfers", "bytes",
+         "us @100k", "@400k", "@1M");
+
+  if (!vcnl4020.begin(&Wire)) {
+    printf("Failed to initialize the simulated VCNL4020\n");
+    return 1;
+  }
+  report("begin()", 1);
+
+  for (uint16_t i = 0; i < ITERATIONS; i++)
+    vcnl4020.readProximity();
+  report("readProximity()", ITERATIONS);
+
+  for (uint16_t i = 0; i < ITERATIONS; i++)
+    vcnl4020.readAmbient();
+  report("readAmbient()", ITERATIONS);
+
+  vcnl4020_sample sample;
+  for (uint16_t i = 0; i < ITERATIONS; i++)
+    vcnl4020.readSample(&sample);
+  report("readSample()", ITERATIONS);
+
+  // The vcnl4020_proxplotter loop, polled once per conversion
+  uint16_t done = 0;
+  while (done < ITERATIONS) {
+    hostAdvance(5000);
+    if (vcnl4020.isProxReady()) {
+      vcnl4020.readProximity();
+      vcnl4020.clearInterrupts(true, false, false, false);
+      done++;
+    }
+  }
+  report("proxplotter loop, per sample", ITERATIONS);
+
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    vcnl4020.setProxRate(PROX_RATE_250_PER_S);
+    vcnl4020.setProxLEDmA(200);
+    vcnl4020.setAmbientRate(AMBIENT_RATE_10_SPS);
+    vcnl4020.setAmbientAveraging(AVG_1_SAMPLES);
+    vcnl4020.setProxFrequency(PROX_FREQ_390_625_KHZ);
+    vcnl4020.setLowThreshold(0);
+    vcnl4020.setHighThreshold(0);
+  }
+  report("seven config setters", ITERATIONS);
+
+  for (uint16_t i = 0; i < ITERATIONS; i++)
+    vcnl4020.setInterruptConfig(true, true, false, false, INT_COUNT_1);
+  report("setInterruptConfig()", ITERATIONS);
+
+  vcnl4020_config config;
+  Adafruit_VCNL4020::getDefaultConfig(&config);
+  config.proxRate = PROX_RATE_125_PER_S;
+  config.highThreshold = 1000;
+  vcnl4020.applyConfig(&config);
+  report("applyConfig(), two changes", 1);
+
+  return 0;
+}
@@ -0,0 +1,69 @@
+/*!
+ * @file host_test.cpp
+ *
+ * Runner for the host tests: runs every test, or those whose name contains
+ * the first argument, and exits non-zero if any check failed.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "host_test.h"
+
+HostTest *HostTest::_first = NULL;
+int HostTest::_failures = 0;
+
+HostTest::HostTest(const char *name, void (*body)(void)) {
+  _name = name;
+  _body = body;
+  _next = _first;
+  _first = this;
+}
+
+/*!
+ * @brief  Runs the registered tests in the order they were defined.
+ * @param  filter  Only run tests whose name contains this, or NULL for all.
+ * @return The number of tests that failed.
+ */
+int HostTest::runAll(const char *filter) {
+  // Registration prepends, so reverse the list to run in definition order
+  HostTest *ordered = NULL;
+  while (_first) {
+    HostTest *test = _first;
+    _first = test->_next;
+    test->_next = ordered;
+    ordered = test;
+  }
+  _first = ordered;
+
+  int run = 0, failed = 0;
+  for (HostTest *test = _first; test; test = test->_next) {
+    if (filter && !strstr(test->_name, filter))
+      continue;
+    hostReset();
+    _failures = 0;
+    test->_body();
+    run++;
+    if (_failures) {
+      failed++;
+      printf("FAIL %s\n", test->_name);
+    }
+  }
+  printf("%d of %d tests passed\n", run - failed, run);
+  return failed;
+}
+
+/*!
+ * @brief  Reports a failed check.
+ * @param  file  Source file of the check.
+ * @param  line  Line of the check.
+ * @param  what  What was checked.
+ */
+void HostTest::fail(const char *file, int line, const char *what) {
+  printf("%s:%d: check failed: %s\n", file, line, what);
+  _failures++;
+}
+
+int main(int argc, char **argv) {
+  return HostTest::runAll(argc > 1 ? argv[1] : NULL) ? 1 : 0;
+}
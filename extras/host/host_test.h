@@ -0,0 +1,60 @@
+/*!
+ * @file host_test.h
+ *
+ * Minimal test registry for the host tests: TEST() defines a test that the
+ * runner in host_test.cpp calls with a fresh clock, CHECK() and CHECK_EQ()
+ * report failures without stopping the test.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include "Arduino.h"
+
+/** One registered test */
+class HostTest {
+public:
+  HostTest(const char *name, void (*body)(void));
+
+  static int runAll(const char *filter);
+  static void fail(const char *file, int line, const char *what);
+
+private:
+  const char *_name;   ///< Test name
+  void (*_body)(void); ///< Test function
+  HostTest *_next;     ///< Next registered test
+
+  static HostTest *_first; ///< Registered tests, in reverse order
+  static int _failures;    ///< Failed checks in the running test
+};
+
+/** Defines and registers a test */
+#define TEST(name)                                                             \
+  static void name(void);                                                      \
+  static HostTest name##_test(#name, name);                                    \
+  static void name(void)
+
+/** Checks that a condition holds */
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond))                                                               \
+      HostTest::fail(__FILE__, __LINE__, #cond);                               \
+  } while (0)
+
+/** Checks that two integers are equal, printing both if not */
+#define CHECK_EQ(actual, expected)                                             \
+  do {                                                                         \
+    long long actual_ = (long long)(actual);                                   \
+    long long expected_ = (long long)(expected);                               \
+    if (actual_ != expected_) {                                                \
+      char what_[160];                                                         \
+      snprintf(what_, sizeof(what_), "%s == %s (%lld != %lld)", #actual,       \
+               #expected, actual_, expected_);                                 \
+      HostTest::fail(__FILE__, __LINE__, what_);                               \
+    }                                                                          \
+  } while (0)
+
+#endif // HOST_TEST_H
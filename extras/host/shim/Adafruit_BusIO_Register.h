@@ -0,0 +1,101 @@
+/*!
+ * @file Adafruit_BusIO_Register.h
+ *
+ * Host stand-in for Adafruit BusIO's register helpers, with the same bus
+ * traffic: one transaction per read or write, and a read followed by a write
+ * for every Adafruit_BusIO_RegisterBits::write().
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef HOST_ADAFRUIT_BUSIO_REGISTER_H
+#define HOST_ADAFRUIT_BUSIO_REGISTER_H
+
+#include "Adafruit_I2CDevice.h"
+
+#ifndef MSBFIRST
+#define LSBFIRST 0 ///< Least significant byte first
+#define MSBFIRST 1 ///< Most significant byte first
+#endif
+
+/** A register of 1 to 4 bytes on an I2C device */
+class Adafruit_BusIO_Register {
+public:
+  Adafruit_BusIO_Register(Adafruit_I2CDevice *i2cdevice, uint16_t reg_addr,
+                          uint8_t width = 1, uint8_t byteorder = LSBFIRST,
+                          uint8_t address_width = 1)
+      : _device(i2cdevice), _address(reg_addr), _width(width),
+        _byteorder(byteorder) {
+    (void)address_width;
+  }
+
+  bool read(uint8_t *buffer, uint8_t len) {
+    uint8_t addr = _address;
+    return _device->write_then_read(&addr, 1, buffer, len);
+  }
+
+  uint32_t read() {
+    uint8_t buffer[4] = {0, 0, 0, 0};
+    if (!read(buffer, _width))
+      return (uint32_t)-1;
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < _width; i++) {
+      uint8_t b = (_byteorder == MSBFIRST) ? buffer[i] : buffer[_width - 1 - i];
+      value = (value << 8) | b;
+    }
+    return value;
+  }
+
+  bool write(uint8_t *buffer, uint8_t len) {
+    uint8_t addr = _address;
+    return _device->write(buffer, len, true, &addr, 1);
+  }
+
+  bool write(uint32_t value, uint8_t numbytes = 0) {
+    if (numbytes == 0)
+      numbytes = _width;
+    uint8_t buffer[4];
+    for (uint8_t i = 0; i < numbytes; i++) {
+      uint8_t pos = (_byteorder == MSBFIRST) ? numbytes - 1 - i : i;
+      buffer[pos] = value & 0xFF;
+      value >>= 8;
+    }
+    return write(buffer, numbytes);
+  }
+
+  uint8_t width() { return _width; }
+
+private:
+  Adafruit_I2CDevice *_device; ///< The device the register is on
+  uint8_t _address;            ///< Register address
+  uint8_t _width;              ///< Bytes in the register
+  uint8_t _byteorder;          ///< LSBFIRST or MSBFIRST
+};
+
+/** A bit field inside an Adafruit_BusIO_Register */
+class Adafruit_BusIO_RegisterBits {
+public:
+  Adafruit_BusIO_RegisterBits(Adafruit_BusIO_Register *reg, uint8_t bits,
+                              uint8_t shift)
+      : _register(reg), _bits(bits), _shift(shift) {}
+
+  uint32_t read() {
+    return (_register->read() >> _shift) & ((1UL << _bits) - 1);
+  }
+
+  bool write(uint32_t data) {
+    uint32_t mask = (1UL << _bits) - 1;
+    uint32_t value = _register->read();
+    value &= ~(mask << _shift);
+    value |= (data & mask) << _shift;
+    return _register->write(value, _register->width());
+  }
+
+private:
+  Adafruit_BusIO_Register *_register; ///< The register holding the field
+  uint8_t _bits;                      ///< Field width
+  uint8_t _shift;                     ///< Field position
+};
+
+#endif // HOST_ADAFRUIT_BUSIO_REGISTER_H
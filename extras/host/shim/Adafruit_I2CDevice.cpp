@@ -0,0 +1,161 @@
+/*!
+ * @file Adafruit_I2CDevice.cpp
+ *
+ * Host stand-in for Adafruit BusIO's I2C device.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_I2CDevice.h"
+
+#define HOST_I2C_MAX_BUFFER 32 ///< Same as the AVR Wire buffer
+
+TwoWire Wire;
+
+static HostI2CTarget *hostTargets[128]; ///< Targets by 7-bit address
+static HostI2CMux *hostMux;             ///< Multiplexer on the bus, or NULL
+
+/*!
+ * @brief  Puts a target on the bus, or takes it off.
+ * @param  addr    The 7-bit address.
+ * @param  target  The target, or NULL to leave the address unanswered.
+ */
+void hostAttachTarget(uint8_t addr, HostI2CTarget *target) {
+  hostTargets[addr & 0x7F] = target;
+}
+
+/*!
+ * @brief  Finds the target answering at an address, directly on the bus or
+ * behind the enabled channel of the multiplexer.
+ * @param  addr  The 7-bit address.
+ * @return The target, or NULL if nothing answers.
+ */
+static HostI2CTarget *hostTarget(uint8_t addr) {
+  if (hostTargets[addr])
+    return hostTargets[addr];
+  return hostMux ? hostMux->route(addr) : NULL;
+}
+
+/*!
+ * @brief  Puts the multiplexer on the bus with no channel enabled.
+ * @param  addr  The 7-bit address of the multiplexer.
+ */
+HostI2CMux::HostI2CMux(uint8_t addr) {
+  _addr = addr & 0x7F;
+  channels = 0;
+  writes = 0;
+  memset(_targets, 0, sizeof(_targets));
+  hostAttachTarget(_addr, this);
+  hostMux = this;
+}
+
+HostI2CMux::~HostI2CMux() {
+  hostAttachTarget(_addr, NULL);
+  if (hostMux == this)
+    hostMux = NULL;
+}
+
+/*!
+ * @brief  Moves a target behind a channel, taking it off the main bus.
+ * @param  channel  The channel, 0 - 7.
+ * @param  addr     The target's 7-bit address.
+ * @param  target   The target, e.g. a VCNL4020_Sim.
+ */
+void HostI2CMux::attach(uint8_t channel, uint8_t addr, HostI2CTarget *target) {
+  if (hostTargets[addr & 0x7F] == target)
+    hostAttachTarget(addr, NULL);
+  _targets[channel & 0x07] = target;
+  _targetAddrs[channel & 0x07] = addr & 0x7F;
+}
+
+/*!
+ * @brief  Finds the target at an address behind the enabled channels.
+ * @param  addr  The 7-bit address.
+ * @return The target, or NULL if none or more than one would answer.
+ */
+HostI2CTarget *HostI2CMux::route(uint8_t addr) {
+  HostI2CTarget *found = NULL;
+  for (uint8_t channel = 0; channel < 8; channel++) {
+    if (!(channels & (1 << channel)) || !_targets[channel] ||
+        _targetAddrs[channel] != addr)
+      continue;
+    if (found)
+      return NULL;
+    found = _targets[channel];
+  }
+  return found;
+}
+
+/*!
+ * @brief  Takes a write of the control register.
+ * @param  data  The new channel bits, NULL for a probe.
+ * @param  len   1, or 0 for a probe.
+ * @return True to acknowledge.
+ */
+bool HostI2CMux::i2cWrite(const uint8_t *data, size_t len) {
+  if (len == 0)
+    return true;
+  if (len != 1)
+    return false;
+  channels = data[0];
+  writes++;
+  return true;
+}
+
+/*!
+ * @brief  Takes a read of the control register.
+ * @param  data  Where to store the channel bits.
+ * @param  len   How many bytes, each gets the control register.
+ * @return True to acknowledge.
+ */
+bool HostI2CMux::i2cRead(uint8_t *data, size_t len) {
+  memset(data, channels, len);
+  return true;
+}
+
+Adafruit_I2CDevice::Adafruit_I2CDevice(uint8_t addr, TwoWire *theWire) {
+  (void)theWire;
+  _addr = addr & 0x7F;
+}
+
+uint8_t Adafruit_I2CDevice::address() { return _addr; }
+
+bool Adafruit_I2CDevice::begin(bool addr_detect) {
+  return !addr_detect || detected();
+}
+
+bool Adafruit_I2CDevice::detected() {
+  HostI2CTarget *target = hostTarget(_addr);
+  return target && target->i2cWrite(NULL, 0);
+}
+
+size_t Adafruit_I2CDevice::maxBufferSize() { return HOST_I2C_MAX_BUFFER; }
+
+bool Adafruit_I2CDevice::read(uint8_t *buffer, size_t len, bool stop) {
+  (void)stop;
+  HostI2CTarget *target = hostTarget(_addr);
+  return target && len <= HOST_I2C_MAX_BUFFER && target->i2cRead(buffer, len);
+}
+
+bool Adafruit_I2CDevice::write(const uint8_t *buffer, size_t len, bool stop,
+                               const uint8_t *prefix_buffer,
+                               size_t prefix_len) {
+  (void)stop;
+  HostI2CTarget *target = hostTarget(_addr);
+  uint8_t data[HOST_I2C_MAX_BUFFER];
+  if (!target || prefix_len + len > sizeof(data))
+    return false;
+  if (prefix_len)
+    memcpy(data, prefix_buffer, prefix_len);
+  if (len)
+    memcpy(&data[prefix_len], buffer, len);
+  return target->i2cWrite(data, prefix_len + len);
+}
+
+bool Adafruit_I2CDevice::write_then_read(const uint8_t *write_buffer,
+                                         size_t write_len,
+                                         uint8_t *read_buffer,
+                                         size_t read_len, bool stop) {
+  return write(write_buffer, write_len, stop) && read(read_buffer, read_len);
+}
@@ -0,0 +1,85 @@
+/*!
+ * @file Adafruit_I2CDevice.h
+ *
+ * Host stand-in for Adafruit BusIO's I2C device. Transactions go to whatever
+ * HostI2CTarget is attached at the device's address, e.g. a chip simulator,
+ * or to a target behind a channel of a HostI2CMux.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef HOST_ADAFRUIT_I2CDEVICE_H
+#define HOST_ADAFRUIT_I2CDEVICE_H
+
+#include "Wire.h"
+
+/** Something that answers on the host I2C bus */
+class HostI2CTarget {
+public:
+  virtual ~HostI2CTarget() {}
+  /*!
+   * @brief  Takes one write transaction.
+   * @param  data  The bytes after the address byte, NULL for a probe.
+   * @param  len   How many bytes.
+   * @return True to acknowledge.
+   */
+  virtual bool i2cWrite(const uint8_t *data, size_t len) = 0;
+  /*!
+   * @brief  Takes one read transaction.
+   * @param  data  Where to store the bytes read.
+   * @param  len   How many bytes.
+   * @return True to acknowledge.
+   */
+  virtual bool i2cRead(uint8_t *data, size_t len) = 0;
+};
+
+void hostAttachTarget(uint8_t addr, HostI2CTarget *target);
+
+/**
+ * TCA9548A-style I2C multiplexer on the host bus: one control register with a
+ * bit per channel, and one target behind each channel. A target answers only
+ * while its channel is the one enabled, so a sensor read on the wrong channel
+ * fails just as it does with several identical chips on a real mux.
+ */
+class HostI2CMux : public HostI2CTarget {
+public:
+  HostI2CMux(uint8_t addr = 0x70);
+  ~HostI2CMux();
+
+  void attach(uint8_t channel, uint8_t addr, HostI2CTarget *target);
+  HostI2CTarget *route(uint8_t addr);
+
+  bool i2cWrite(const uint8_t *data, size_t len);
+  bool i2cRead(uint8_t *data, size_t len);
+
+  uint8_t channels; ///< Control register, one bit per enabled channel
+  uint32_t writes;  ///< Acknowledged control register writes
+
+private:
+  uint8_t _addr;              ///< Bus address of the mux itself
+  HostI2CTarget *_targets[8]; ///< Target behind each channel, or NULL
+  uint8_t _targetAddrs[8];    ///< Address of each channel's target
+};
+
+/** I2C device with the BusIO calls the library uses */
+class Adafruit_I2CDevice {
+public:
+  Adafruit_I2CDevice(uint8_t addr, TwoWire *theWire = &Wire);
+
+  uint8_t address();
+  bool begin(bool addr_detect = true);
+  bool detected();
+  size_t maxBufferSize();
+  bool read(uint8_t *buffer, size_t len, bool stop = true);
+  bool write(const uint8_t *buffer, size_t len, bool stop = true,
+             const uint8_t *prefix_buffer = NULL, size_t prefix_len = 0);
+  bool write_then_read(const uint8_t *write_buffer, size_t write_len,
+                       uint8_t *read_buffer, size_t read_len,
+                       bool stop = false);
+
+private:
+  uint8_t _addr; ///< 7-bit address
+};
+
+#endif // HOST_ADAFRUIT_I2CDEVICE_H
@@ -0,0 +1,93 @@
+/*!
+ * @file Arduino.cpp
+ *
+ * Host stand-in for the Arduino core: simulated clock and pins.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Arduino.h"
+
+static uint32_t hostMicros = 1000000;         ///< Simulated micros()
+static uint8_t hostLevels[HOST_PINS];         ///< Pin levels, HIGH at reset
+static void (*hostHandlers[HOST_PINS])(void); ///< attachInterrupt() handlers
+static int hostModes[HOST_PINS];              ///< attachInterrupt() modes
+
+uint32_t micros() { return hostMicros; }
+
+uint32_t millis() { return hostMicros / 1000; }
+
+void delay(uint32_t ms) { hostMicros += ms * 1000; }
+
+void delayMicroseconds(uint32_t us) { hostMicros += us; }
+
+void noInterrupts() {}
+
+void interrupts() {}
+
+void pinMode(int pin, int mode) { (void)pin, (void)mode; }
+
+int digitalRead(int pin) {
+  return (pin >= 0 && pin < HOST_PINS) ? hostLevels[pin] : HIGH;
+}
+
+int digitalPinToInterrupt(int pin) {
+  return (pin >= 0 && pin < HOST_PINS) ? pin : NOT_AN_INTERRUPT;
+}
+
+void attachInterrupt(int interrupt, void (*handler)(void), int mode) {
+  if (interrupt < 0 || interrupt >= HOST_PINS)
+    return;
+  hostHandlers[interrupt] = handler;
+  hostModes[interrupt] = mode;
+}
+
+void detachInterrupt(int interrupt) {
+  if (interrupt >= 0 && interrupt < HOST_PINS)
+    hostHandlers[interrupt] = NULL;
+}
+
+/*!
+ * @brief  Puts the clock at start, all pins HIGH and detaches every handler.
+ * @param  start  The new micros().
+ */
+void hostReset(uint32_t start) {
+  hostMicros = start;
+  memset(hostLevels, HIGH, sizeof(hostLevels));
+  memset(hostHandlers, 0, sizeof(hostHandlers));
+}
+
+/*!
+ * @brief  Moves the simulated clock forward.
+ * @param  us  Microseconds to add.
+ */
+void hostAdvance(uint32_t us) { hostMicros += us; }
+
+/*!
+ * @brief  Drives a pin, running its interrupt handler on a matching edge.
+ * @param  pin    The pin.
+ * @param  level  LOW or HIGH.
+ */
+void hostWritePin(int pin, int level) {
+  if (pin < 0 || pin >= HOST_PINS || hostLevels[pin] == level)
+    return;
+  hostLevels[pin] = level;
+
+  int mode = hostModes[pin];
+  bool edge = mode == CHANGE || (mode == FALLING && level == LOW) ||
+              (mode == RISING && level == HIGH);
+  if (hostHandlers[pin] && edge)
+    hostHandlers[pin]();
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t written = 0;
+  while (size--)
+    written += write(*buffer++);
+  return written;
+}
+
+size_t Print::print(const char *text) {
+  return write((const uint8_t *)text, strlen(text));
+}
@@ -0,0 +1,70 @@
+/*!
+ * @file Arduino.h
+ *
+ * Host stand-in for the parts of the Arduino core the library uses, so the
+ * library builds and runs on a PC. Time is simulated: micros() returns a
+ * clock that only moves when a test calls hostAdvance() or the code under
+ * test calls delay(). INT pins are driven by the chip simulator through
+ * hostWritePin(), which also runs the attached interrupt handler.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOW 0
+#define HIGH 1
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define NOT_AN_INTERRUPT -1
+#define HOST_PINS 32 ///< Pins the host stand-in keeps a level for
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+uint32_t micros();
+uint32_t millis();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void noInterrupts();
+void interrupts();
+void pinMode(int pin, int mode);
+int digitalRead(int pin);
+int digitalPinToInterrupt(int pin);
+void attachInterrupt(int interrupt, void (*handler)(void), int mode);
+void detachInterrupt(int interrupt);
+
+void hostReset(uint32_t start = 1000000);
+void hostAdvance(uint32_t us);
+void hostWritePin(int pin, int level);
+
+/** Byte sink, as the Arduino core's Print */
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t print(const char *text);
+};
+
+#endif // HOST_ARDUINO_H
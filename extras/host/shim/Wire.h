@@ -0,0 +1,25 @@
+/*!
+ * @file Wire.h
+ *
+ * Host stand-in for the Arduino Wire library. The bus itself lives in the
+ * Adafruit_I2CDevice stand-in, this only provides the TwoWire type.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include "Arduino.h"
+
+/** I2C controller, a placeholder on the host */
+class TwoWire {
+public:
+  void begin() {}
+  void setClock(uint32_t frequency) { (void)frequency; }
+};
+
+extern TwoWire Wire;
+
+#endif // HOST_WIRE_H
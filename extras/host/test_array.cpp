@@ -0,0 +1,79 @@
+/*!
+ * @file test_array.cpp
+ *
+ * Host tests of several sensors behind an I2C multiplexer.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Array.h"
+#include "VCNL4020_Sim.h"
+#include "host_test.h"
+
+TEST(array_reads_every_sensor_on_its_channel) {
+  VCNL4020_Sim sims[3];
+  HostI2CMux mux;
+  const uint8_t channels[] = {5, 1, 3};
+  for (uint8_t i = 0; i < 3; i++) {
+    mux.attach(channels[i], VCNL4020_I2C_ADDRESS, &sims[i]);
+    sims[i].setProximity(1000 + i);
+    sims[i].setAmbient(2000 + i);
+  }
+
+  Adafruit_VCNL4020_Array<3> array;
+  CHECK(array.begin(channels));
+  CHECK_EQ(array.channel(0), 5);
+  CHECK_EQ(mux.channels, 1 << 5); // begin() walks the channels in order
+
+  hostAdvance(200000);
+  for (uint8_t i = 0; i < 3; i++) {
+    sims[i].tick();
+    sims[i].resetCounters();
+  }
+  mux.writes = 0;
+
+  vcnl4020_array_reading frame[3];
+  CHECK(array.readFrame(frame));
+  for (uint8_t i = 0; i < 3; i++) {
+    CHECK(frame[i].valid);
+    CHECK_EQ(frame[i].proximity, 1000 + i);
+    CHECK_EQ(frame[i].ambient, 2000 + i);
+    CHECK_EQ(sims[i].reads, 1);
+    CHECK_EQ(sims[i].writes, 0);
+  }
+
+  // The frame starts on the channel left selected, saving one switch
+  CHECK_EQ(mux.writes, 2);
+  CHECK(array.readFrame(frame));
+  CHECK_EQ(mux.writes, 4);
+}
+
+TEST(array_reports_a_missing_sensor) {
+  VCNL4020_Sim sims[2];
+  HostI2CMux mux;
+  const uint8_t channels[] = {0, 7};
+  mux.attach(0, VCNL4020_I2C_ADDRESS, &sims[0]);
+  mux.attach(7, VCNL4020_I2C_ADDRESS, &sims[1]);
+
+  Adafruit_VCNL4020_Array<2> array;
+  CHECK(array.begin(channels));
+
+  sims[1].present = false;
+  vcnl4020_array_reading frame[2];
+  CHECK(!array.readFrame(frame));
+  CHECK(frame[0].valid);
+  CHECK(!frame[1].valid);
+
+  // A sensor on an unwired channel fails begin()
+  Adafruit_VCNL4020_Array<2> miswired;
+  const uint8_t wrong[] = {0, 6};
+  CHECK(!miswired.begin(wrong));
+}
+
+TEST(array_without_a_mux_fails) {
+  VCNL4020_Sim sim;
+  const uint8_t channels[] = {0};
+  Adafruit_VCNL4020_Array<1> array;
+  CHECK(!array.begin(channels));
+}
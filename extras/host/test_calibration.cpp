@@ -0,0 +1,171 @@
+/*!
+ * @file test_calibration.cpp
+ *
+ * Host tests of crosstalk calibration and its persisted blob.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Calibration.h"
+#include "VCNL4020_Sim.h"
+#include "host_test.h"
+
+static VCNL4020_Sim *failingSim; ///< Chip to knock off the bus, or NULL
+static uint16_t clockCalls;      ///< Calls left before it drops off
+
+/*!
+ * @brief  Clock that moves on with every call, so the busy wait of an
+ * on-demand measurement sees the conversion finish.
+ * @return micros() after a 50 us step.
+ */
+static uint32_t steppingClock() {
+  hostAdvance(50);
+  if (failingSim && clockCalls && --clockCalls == 0)
+    failingSim->present = false;
+  return micros();
+}
+
+/*!
+ * @brief  Starts a sensor on the simulator with the stepping clock.
+ * @param  vcnl  The sensor.
+ */
+static void start(Adafruit_VCNL4020 &vcnl) {
+  failingSim = NULL;
+  clockCalls = 0;
+  vcnl.setClock(steppingClock);
+  vcnl.setRetries(0, 0);
+  CHECK(vcnl.begin());
+}
+
+TEST(calibrate_subtracts_the_offset_at_its_setting) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_Calibration calibration(&vcnl);
+  start(vcnl);
+  CHECK(vcnl.enable(true, true, true));
+  uint8_t command = sim.peek(VCNL4020_REG_COMMAND);
+
+  sim.setProximity(480);
+  CHECK(calibration.calibrate(4));
+  CHECK_EQ(vcnl.getProxOffset(), 480);
+  CHECK_EQ(sim.peek(VCNL4020_REG_COMMAND) & 0x07, command & 0x07);
+
+  sim.setProximity(2000);
+  CHECK(vcnl.setProxRate(PROX_RATE_250_PER_S));
+  hostAdvance(10000);
+  sim.tick();
+  CHECK_EQ(vcnl.readProximity(), 2000 - 480);
+
+  // Clamped at 0, and another LED current is not compensated
+  sim.setProximity(100);
+  hostAdvance(10000);
+  sim.tick();
+  CHECK_EQ(vcnl.readProximity(), 0);
+  CHECK(vcnl.setProxLEDmA(100));
+  CHECK_EQ(vcnl.getProxOffset(), 0);
+  hostAdvance(10000);
+  sim.tick();
+  CHECK_EQ(vcnl.readProximity(), 100);
+}
+
+TEST(calibration_blob_round_trips) {
+  vcnl4020_calibration cal;
+  {
+    VCNL4020_Sim sim;
+    Adafruit_VCNL4020 vcnl;
+    Adafruit_VCNL4020_Calibration calibration(&vcnl);
+    start(vcnl);
+    const uint8_t currents[] = {50, 100};
+    sim.setProximity(300);
+    CHECK(calibration.calibrate(currents, 2, 2, PROX_FREQ_390_625_KHZ,
+                                PROX_FREQ_781_25_KHZ));
+    calibration.getCalibration(&cal);
+    CHECK_EQ(cal.version, VCNL4020_CAL_VERSION);
+    CHECK_EQ(cal.count, 4);
+  }
+
+  // Restored before begin(), and kept by it
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_Calibration calibration(&vcnl);
+  CHECK(calibration.setCalibration(&cal));
+  start(vcnl);
+  CHECK(vcnl.setProxLEDmA(100));
+  CHECK(vcnl.setProxFrequency(PROX_FREQ_781_25_KHZ));
+  CHECK_EQ(vcnl.getProxOffset(), 300);
+
+  // A damaged or foreign blob is refused and the calibration kept
+  vcnl4020_calibration bad = cal;
+  bad.entries[0].offset++;
+  CHECK(!calibration.setCalibration(&bad));
+  bad = cal;
+  bad.version++;
+  CHECK(!calibration.setCalibration(&bad));
+  CHECK_EQ(vcnl.getProxOffset(), 300);
+
+  // Taken off the sensor and put back
+  vcnl.setProxCalibration(NULL);
+  CHECK_EQ(vcnl.getProxOffset(), 0);
+  vcnl.setProxCalibration(&calibration);
+  CHECK_EQ(vcnl.getProxOffset(), 300);
+
+  calibration.clear();
+  CHECK_EQ(vcnl.getProxOffset(), 0);
+}
+
+TEST(oversized_sweep_keeps_the_calibration) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_Calibration calibration(&vcnl);
+  start(vcnl);
+  const uint8_t currents[] = {20, 40, 60, 80};
+  sim.setProximity(250);
+  CHECK(calibration.calibrate(currents, 3, 2, PROX_FREQ_390_625_KHZ,
+                              PROX_FREQ_781_25_KHZ));
+  vcnl4020_calibration before, after;
+  calibration.getCalibration(&before);
+
+  // 4 x 4 settings do not fit, and are refused without bus traffic
+  sim.setProximity(900);
+  sim.resetCounters();
+  CHECK(!calibration.calibrate(currents, 4, 2, PROX_FREQ_390_625_KHZ,
+                               PROX_FREQ_3_125_MHZ));
+  CHECK_EQ(sim.reads + sim.writes, 0);
+
+  // Neither do three new settings on top of the six stored
+  CHECK(!calibration.calibrate(currents + 1, 3, 2, PROX_FREQ_1_5625_MHZ,
+                               PROX_FREQ_1_5625_MHZ));
+  CHECK_EQ(sim.reads + sim.writes, 0);
+  calibration.getCalibration(&after);
+  CHECK(memcmp(&before, &after, sizeof(before)) == 0);
+
+  // Re-measuring settings already stored fits
+  CHECK(calibration.calibrate(currents + 1, 2, 2, PROX_FREQ_390_625_KHZ,
+                              PROX_FREQ_781_25_KHZ));
+  calibration.getCalibration(&after);
+  CHECK_EQ(after.count, 6);
+}
+
+TEST(failed_sweep_keeps_the_calibration) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_Calibration calibration(&vcnl);
+  start(vcnl);
+  const uint8_t currents[] = {100, 200};
+  sim.setProximity(250);
+  CHECK(calibration.calibrate(currents, 2, 4, PROX_FREQ_390_625_KHZ,
+                              PROX_FREQ_781_25_KHZ));
+  vcnl4020_calibration before, after;
+  calibration.getCalibration(&before);
+
+  // The chip drops off the bus part way through the sweep
+  sim.setProximity(900);
+  failingSim = &sim;
+  clockCalls = 60;
+  CHECK(!calibration.calibrate(currents, 2, 4, PROX_FREQ_390_625_KHZ,
+                               PROX_FREQ_781_25_KHZ));
+  CHECK_EQ(clockCalls, 0);
+  calibration.getCalibration(&after);
+  CHECK(memcmp(&before, &after, sizeof(before)) == 0);
+}
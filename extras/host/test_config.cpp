@@ -0,0 +1,142 @@
+/*!
+ * @file test_config.cpp
+ *
+ * Host tests of begin(), applyConfig() register diffing and the shadow cache.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020.h"
+#include "Adafruit_VCNL4020_Recorder.h"
+#include "VCNL4020_Sim.h"
+#include "host_test.h"
+
+TEST(begin_programs_defaults) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(vcnl.begin());
+
+  CHECK_EQ(sim.peek(VCNL4020_REG_COMMAND) & 0x07, 0x07);
+  CHECK_EQ(sim.peek(VCNL4020_REG_PROX_RATE), PROX_RATE_250_PER_S);
+  CHECK_EQ(sim.peek(VCNL4020_REG_IR_LED_CURRENT), 20);
+  CHECK_EQ(sim.peek(VCNL4020_REG_AMBIENT_PARAM), 0x78);
+  CHECK_EQ(sim.peek(VCNL4020_REG_INT_CTRL),
+           VCNL4020_INTCTRL_PROX_READY | VCNL4020_INTCTRL_ALS_READY);
+}
+
+TEST(begin_fails_without_chip) {
+  VCNL4020_Sim sim;
+  sim.present = false;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(!vcnl.begin());
+}
+
+TEST(apply_unchanged_config_is_free) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(vcnl.begin());
+
+  vcnl4020_config config;
+  vcnl.getConfig(&config);
+  sim.resetCounters();
+  CHECK(vcnl.applyConfig(&config));
+  CHECK_EQ(sim.reads, 0);
+  CHECK_EQ(sim.writes, 0);
+}
+
+TEST(apply_writes_only_the_changed_register) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(vcnl.begin());
+
+  vcnl4020_config config;
+  vcnl.getConfig(&config);
+  config.proxLEDmA = 100;
+  sim.resetCounters();
+  CHECK(vcnl.applyConfig(&config));
+
+  // Pause, the LED current, then the enables again
+  CHECK_EQ(sim.reads, 0);
+  CHECK_EQ(sim.writes, 3);
+  CHECK_EQ(sim.peek(VCNL4020_REG_IR_LED_CURRENT), 10);
+  CHECK_EQ(sim.peek(VCNL4020_REG_COMMAND) & 0x07, 0x07);
+}
+
+TEST(apply_bursts_neighbouring_registers) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(vcnl.begin());
+
+  vcnl4020_config config;
+  vcnl.getConfig(&config);
+  config.lowThreshold = 0x0102;
+  config.highThreshold = 0x0304;
+  sim.resetCounters();
+  CHECK(vcnl.applyConfig(&config));
+
+  // All four threshold bytes go out in one write, without a pause
+  CHECK_EQ(sim.writes, 1);
+  CHECK_EQ(sim.peek(VCNL4020_REG_LOW_THRES_HIGH), 0x01);
+  CHECK_EQ(sim.peek(VCNL4020_REG_LOW_THRES_LOW), 0x02);
+  CHECK_EQ(sim.peek(VCNL4020_REG_HIGH_THRES_HIGH), 0x03);
+  CHECK_EQ(sim.peek(VCNL4020_REG_HIGH_THRES_LOW), 0x04);
+}
+
+TEST(apply_enables_only_needs_no_pause) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(vcnl.begin());
+
+  vcnl4020_config config;
+  vcnl.getConfig(&config);
+  config.alsEnable = false;
+  sim.resetCounters();
+  CHECK(vcnl.applyConfig(&config));
+  CHECK_EQ(sim.writes, 1);
+  CHECK_EQ(sim.peek(VCNL4020_REG_COMMAND) & 0x07, 0x03);
+}
+
+TEST(getters_use_the_shadow_cache) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(vcnl.begin());
+
+  sim.resetCounters();
+  CHECK_EQ(vcnl.getProxRate(), PROX_RATE_250_PER_S);
+  CHECK_EQ(vcnl.getProxLEDmA(), 200);
+  CHECK_EQ(vcnl.getAmbientAveraging(), AVG_1_SAMPLES);
+  CHECK_EQ(sim.reads, 0);
+
+  // A setter is a single write, no read-modify-write
+  CHECK(vcnl.setProxRate(PROX_RATE_125_PER_S));
+  CHECK_EQ(sim.reads, 0);
+  CHECK_EQ(sim.writes, 1);
+  CHECK_EQ(sim.peek(VCNL4020_REG_PROX_RATE), PROX_RATE_125_PER_S);
+}
+
+TEST(stats_attribute_calls_to_their_own_ops) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_Recorder recorder(&vcnl);
+  CHECK(vcnl.begin());
+  vcnl.resetStats();
+
+  CHECK(vcnl.setProxRate(PROX_RATE_125_PER_S));
+  CHECK(vcnl.setAmbientAveraging(AVG_4_SAMPLES));
+  CHECK(vcnl.setThresholds(10, 20));
+  CHECK(vcnl.enable(true, true, false));
+  CHECK(vcnl.setOnDemand(false, true));
+  vcnl4020_record ambient, proximity;
+  CHECK(recorder.read(&ambient, &proximity));
+
+  CHECK_EQ(vcnl.getStats(VCNL4020_OP_SET_PROX_CONFIG).writes, 1);
+  CHECK_EQ(vcnl.getStats(VCNL4020_OP_SET_AMBIENT_CONFIG).writes, 1);
+  CHECK_EQ(vcnl.getStats(VCNL4020_OP_SET_THRESHOLDS).writes, 1);
+  CHECK_EQ(vcnl.getStats(VCNL4020_OP_ENABLE).writes, 1);
+  CHECK_EQ(vcnl.getStats(VCNL4020_OP_ON_DEMAND).writes, 1);
+  CHECK_EQ(vcnl.getStats(VCNL4020_OP_READ_RECORDS).calls, 1);
+  CHECK_EQ(vcnl.getStats(VCNL4020_OP_READ_RECORDS).reads, 1);
+  CHECK_EQ(vcnl.getStats(VCNL4020_OP_READ_SAMPLE).calls, 0);
+  CHECK_EQ(vcnl.getStats().writes, 5);
+}
@@ -0,0 +1,66 @@
+/*!
+ * @file test_filters.cpp
+ *
+ * Host tests of the proximity filter stage.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020.h"
+#include "Adafruit_VCNL4020_Filter.h"
+#include "VCNL4020_Sim.h"
+#include "host_test.h"
+
+TEST(boxcar_is_the_rounded_mean) {
+  Adafruit_VCNL4020_Filter filter(VCNL4020_FILTER_BOXCAR, 4);
+  filter.push(10);
+  CHECK_EQ(filter.output(), 10);
+  filter.push(20);
+  filter.push(30);
+  filter.push(40);
+  CHECK_EQ(filter.output(), 25);
+  filter.push(50); // 10 leaves the window
+  CHECK_EQ(filter.output(), 35);
+}
+
+TEST(median_drops_a_spike) {
+  Adafruit_VCNL4020_Filter filter(VCNL4020_FILTER_MEDIAN, 5);
+  uint16_t samples[] = {100, 102, 65000, 101, 99};
+  for (uint8_t i = 0; i < 5; i++)
+    filter.push(samples[i]);
+  CHECK_EQ(filter.output(), 101);
+}
+
+TEST(ema_converges_on_a_step) {
+  Adafruit_VCNL4020_Filter filter(VCNL4020_FILTER_EMA, 2);
+  filter.push(0);
+  for (uint8_t i = 0; i < 40; i++)
+    filter.push(1000);
+  CHECK(filter.output() >= 990);
+  CHECK(filter.output() <= 1000);
+}
+
+TEST(decimation_outputs_every_nth_sample) {
+  Adafruit_VCNL4020_Filter filter(VCNL4020_FILTER_NONE, 1, 3);
+  CHECK(!filter.push(1));
+  CHECK(!filter.push(2));
+  CHECK(filter.push(3));
+  CHECK_EQ(filter.output(), 3);
+  CHECK(!filter.push(4));
+}
+
+TEST(driver_runs_the_filter_on_reads) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_Filter filter(VCNL4020_FILTER_BOXCAR, 2);
+  CHECK(vcnl.begin());
+  vcnl.setProxFilter(&filter);
+
+  sim.setProximity(100);
+  hostAdvance(5000);
+  CHECK_EQ(vcnl.readProximity(), 100);
+  sim.setProximity(200);
+  hostAdvance(5000);
+  CHECK_EQ(vcnl.readProximity(), 150);
+}
@@ -0,0 +1,106 @@
+/*!
+ * @file test_governor.cpp
+ *
+ * Host tests of the power governor and the proximity stream it drives.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Governor.h"
+#include "Adafruit_VCNL4020_ProxStream.h"
+#include "VCNL4020_Sim.h"
+#include "host_test.h"
+
+/*!
+ * @brief  Fills in a policy with a single idle level at 125/s.
+ * @param  policy  The policy to fill in.
+ */
+static void oneLevelPolicy(vcnl4020_governor_policy *policy) {
+  Adafruit_VCNL4020_Governor::getDefaultPolicy(policy);
+  policy->idleRate = PROX_RATE_125_PER_S;
+  policy->useThresholdInterrupt = true;
+}
+
+/*!
+ * @brief  Calls next() every 100 us of simulated time.
+ * @param  stream  The proximity stream, started.
+ * @param  sim     The simulated chip, ticked so INT follows conversions.
+ * @param  micros  How long to run.
+ * @return The number of samples delivered.
+ */
+static uint32_t streamFor(Adafruit_VCNL4020_ProxStream &stream,
+                          VCNL4020_Sim &sim, uint32_t micros) {
+  uint32_t delivered = 0;
+  uint16_t proximity;
+  for (uint32_t t = 0; t < micros; t += 100) {
+    hostAdvance(100);
+    sim.tick();
+    delivered += stream.next(&proximity);
+  }
+  return delivered;
+}
+
+TEST(governor_idle_turns_off_ready_interrupts) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_Governor governor(&vcnl);
+  CHECK(vcnl.begin());
+
+  vcnl4020_governor_policy policy;
+  oneLevelPolicy(&policy);
+  CHECK(governor.begin(&policy));
+  CHECK_EQ(governor.levels(), 1);
+
+  hostAdvance(1000000);
+  CHECK(governor.update(0));
+  CHECK_EQ(sim.peek(VCNL4020_REG_INT_CTRL), VCNL4020_INTCTRL_THRESH_EN);
+  CHECK_EQ(sim.peek(VCNL4020_REG_PROX_RATE), PROX_RATE_125_PER_S);
+
+  // Waking restores the application's ready interrupts
+  CHECK(governor.update(5000));
+  CHECK_EQ(sim.peek(VCNL4020_REG_INT_CTRL),
+           VCNL4020_INTCTRL_PROX_READY | VCNL4020_INTCTRL_ALS_READY);
+}
+
+TEST(stream_follows_a_rate_change) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_ProxStream stream(&vcnl);
+  CHECK(vcnl.begin());
+  CHECK(stream.start());
+
+  streamFor(stream, sim, 1000000);
+  vcnl4020_stream_stats before = stream.getStats();
+
+  // Slow down mid-stream, as the governor does when idling
+  CHECK(vcnl.setProxRate(PROX_RATE_7_8_PER_S));
+  streamFor(stream, sim, 2000000);
+  vcnl4020_stream_stats after = stream.getStats();
+
+  // About 15 samples in 2 s, few extra polls and none counted as dropped
+  uint32_t delivered = after.delivered - before.delivered;
+  CHECK(delivered >= 14);
+  CHECK(delivered <= 17);
+  CHECK(after.duplicated - before.duplicated <= delivered * 2);
+  CHECK_EQ(after.dropped, before.dropped);
+}
+
+TEST(stream_switches_pacing_with_the_interrupt_settings) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_ProxStream stream(&vcnl);
+  sim.setIntPin(2);
+  CHECK(vcnl.begin());
+  vcnl.setInterruptPin(2);
+  CHECK(vcnl.setInterruptConfig(true, false, false, false, INT_COUNT_1));
+  CHECK(stream.start());
+
+  CHECK(streamFor(stream, sim, 200000) >= 49);
+  CHECK_EQ(stream.getStats().duplicated, 0);
+
+  // With INT on thresholds only, the stream paces its own reads
+  CHECK(vcnl.setInterruptConfig(false, false, true, false, INT_COUNT_1));
+  CHECK(vcnl.setThresholds(0, 0xFFFE));
+  CHECK(streamFor(stream, sim, 200000) >= 49);
+}
@@ -0,0 +1,131 @@
+/*!
+ * @file test_interrupts.cpp
+ *
+ * Host tests of interrupt-driven sampling.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020.h"
+#include "Adafruit_VCNL4020_ProxStream.h"
+#include "VCNL4020_Sim.h"
+#include "host_test.h"
+
+TEST(fetch_is_one_burst_and_one_acknowledge) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  sim.setIntPin(2);
+  CHECK(vcnl.begin());
+  vcnl.setInterruptPin(2);
+  CHECK(vcnl.setInterruptConfig(true, false, false, false, INT_COUNT_1));
+
+  sim.setProximity(1234);
+  hostAdvance(5000);
+  sim.tick();
+  CHECK_EQ(digitalRead(2), LOW);
+
+  vcnl4020_timed_sample sample;
+  sim.resetCounters();
+  CHECK(vcnl.fetchInterruptSample(&sample));
+  CHECK_EQ(sim.reads, 1);
+  CHECK_EQ(sim.writes, 1);
+  CHECK_EQ(sim.bytes, 1 + 10 + 2); // both register addresses included
+  CHECK_EQ(sample.proximity, 1234);
+  CHECK(sample.status & VCNL4020_INT_PROX_READY);
+  CHECK_EQ(sim.peek(VCNL4020_REG_INT_STATUS), 0);
+  CHECK_EQ(digitalRead(2), HIGH);
+
+  // Nothing pending costs nothing
+  sim.resetCounters();
+  CHECK(!vcnl.fetchInterruptSample(&sample));
+  CHECK_EQ(sim.reads, 0);
+}
+
+TEST(fetch_fails_when_the_acknowledge_fails) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  sim.setIntPin(2);
+  CHECK(vcnl.begin());
+  vcnl.setInterruptPin(2);
+  vcnl.setRetries(0, 0);
+  CHECK(vcnl.setInterruptConfig(true, false, false, false, INT_COUNT_1));
+  hostAdvance(5000);
+  sim.tick();
+
+  vcnl4020_timed_sample sample;
+  sim.passWrites = 1; // the register address of the burst read
+  sim.failWrites = 1;
+  CHECK(!vcnl.fetchInterruptSample(&sample));
+  CHECK_EQ(digitalRead(2), LOW);
+
+  // INT is still asserted, so the next call fetches the sample again
+  CHECK(vcnl.fetchInterruptSample(&sample));
+  CHECK(sample.status & VCNL4020_INT_PROX_READY);
+}
+
+static Adafruit_VCNL4020 *isrSensor; ///< The sensor the ISR below reports to
+
+/*!
+ * @brief  INT pin handler, as in the vcnl4020_interrupts example.
+ */
+static void isr() { isrSensor->handleInterrupt(); }
+
+TEST(failed_fetch_keeps_the_edge_without_an_interrupt_pin) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  sim.setIntPin(2);
+  CHECK(vcnl.begin());
+  vcnl.setRetries(0, 0);
+  isrSensor = &vcnl;
+  attachInterrupt(digitalPinToInterrupt(2), isr, FALLING);
+  CHECK(vcnl.setInterruptConfig(true, false, false, false, INT_COUNT_1));
+  hostAdvance(5000);
+  sim.tick();
+  uint32_t edge = micros();
+  CHECK_EQ(digitalRead(2), LOW);
+
+  // A failed burst read and a failed acknowledge both keep the edge
+  vcnl4020_timed_sample sample;
+  sim.failReads = 1;
+  CHECK(!vcnl.fetchInterruptSample(&sample));
+  sim.passWrites = 1; // the register address of the burst read
+  sim.failWrites = 1;
+  hostAdvance(1000);
+  CHECK(!vcnl.fetchInterruptSample(&sample));
+  CHECK_EQ(digitalRead(2), LOW);
+
+  // INT never fell again, the sample is fetched from the recorded edge
+  CHECK(vcnl.fetchInterruptSample(&sample));
+  CHECK(sample.status & VCNL4020_INT_PROX_READY);
+  CHECK_EQ(sample.timestamp, edge);
+  CHECK_EQ(digitalRead(2), HIGH);
+}
+
+TEST(stream_fails_when_the_acknowledge_fails) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_ProxStream stream(&vcnl);
+  sim.setIntPin(2);
+  CHECK(vcnl.begin());
+  vcnl.setInterruptPin(2);
+  vcnl.setRetries(0, 0);
+  CHECK(vcnl.setInterruptConfig(true, false, false, false, INT_COUNT_1));
+  CHECK(stream.start());
+  sim.setProximity(777);
+  hostAdvance(5000);
+  sim.tick();
+
+  uint16_t proximity = 0;
+  sim.passWrites = 1; // the register address of the result read
+  sim.failWrites = 1;
+  CHECK(!stream.next(&proximity));
+  CHECK_EQ(digitalRead(2), LOW);
+  CHECK_EQ(stream.getStats().delivered, 0);
+
+  // INT is still asserted, so the next call delivers the sample
+  CHECK(stream.next(&proximity));
+  CHECK_EQ(proximity, 777);
+  CHECK_EQ(digitalRead(2), HIGH);
+  CHECK_EQ(stream.getStats().delivered, 1);
+}
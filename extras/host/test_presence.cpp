@@ -0,0 +1,83 @@
+/*!
+ * @file test_presence.cpp
+ *
+ * Host tests of the presence and approach / retreat engine.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Presence.h"
+#include "host_test.h"
+
+/*!
+ * @brief  Feeds the same sample several times.
+ * @param  presence  The engine.
+ * @param  value     The proximity sample.
+ * @param  count     How many times.
+ * @return The events of all the samples, OR-ed.
+ */
+static uint8_t feed(Adafruit_VCNL4020_Presence &presence, uint16_t value,
+                    uint8_t count) {
+  uint8_t events = 0;
+  while (count--)
+    events |= presence.update(value);
+  return events;
+}
+
+TEST(presence_enters_after_dwell_and_leaves) {
+  Adafruit_VCNL4020_Presence presence;
+  vcnl4020_presence_config config;
+  presence.getDefaultConfig(&config);
+  presence.begin(&config);
+
+  CHECK_EQ(feed(presence, 2000, 16), 0);
+  CHECK(!presence.present());
+
+  uint8_t events = feed(presence, 5000, 16);
+  CHECK(events & VCNL4020_PRESENCE_ENTER);
+  CHECK(events & VCNL4020_PRESENCE_APPROACH);
+  CHECK(presence.present());
+
+  events = feed(presence, 2000, 16);
+  CHECK(events & VCNL4020_PRESENCE_LEAVE);
+  CHECK(events & VCNL4020_PRESENCE_RETREAT);
+  CHECK(!presence.present());
+}
+
+TEST(presence_holds_inside_the_hysteresis) {
+  Adafruit_VCNL4020_Presence presence;
+  vcnl4020_presence_config config;
+  presence.getDefaultConfig(&config);
+  presence.begin(&config);
+
+  feed(presence, 5000, 16);
+  CHECK(presence.present());
+  // Between exitLevel and enterLevel nothing changes
+  CHECK_EQ(feed(presence, 2800, 16) & VCNL4020_PRESENCE_LEAVE, 0);
+  CHECK(presence.present());
+}
+
+TEST(presence_ignores_a_short_blip) {
+  Adafruit_VCNL4020_Presence presence;
+  vcnl4020_presence_config config;
+  presence.getDefaultConfig(&config);
+  presence.begin(&config);
+
+  // One sample moves the mean of the newer half by a quarter of its jump
+  feed(presence, 2000, 16);
+  feed(presence, 5000, 1);
+  CHECK_EQ(feed(presence, 2000, 16) & VCNL4020_PRESENCE_ENTER, 0);
+  CHECK(!presence.present());
+}
+
+TEST(presence_skips_spurious_readings) {
+  Adafruit_VCNL4020_Presence presence;
+  vcnl4020_presence_config config;
+  presence.getDefaultConfig(&config);
+  presence.begin(&config);
+
+  feed(presence, 2000, 16);
+  CHECK_EQ(presence.update(0xFFFF), 0);
+  CHECK_EQ(presence.level(), 2000);
+}
@@ -0,0 +1,243 @@
+/*!
+ * @file test_recover.cpp
+ *
+ * Host tests of bus error reporting, retries and recover().
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020.h"
+#include "Adafruit_VCNL4020_Tracker.h"
+#include "VCNL4020_Sim.h"
+#include "host_test.h"
+
+/*!
+ * @brief  Checks that the simulated chip holds the same parameter registers
+ * and enable bits as a snapshot.
+ * @param  sim    The simulated chip.
+ * @param  saved  Registers #0 through #15 as peeked before.
+ */
+static void checkRegisters(VCNL4020_Sim &sim, const uint8_t *saved) {
+  CHECK_EQ(sim.peek(0x80) & 0x07, saved[0] & 0x07);
+  for (uint8_t i = 2; i < 16; i++) {
+    if (i >= 5 && i <= 8)
+      continue; // results
+    if (i != 14)
+      CHECK_EQ(sim.peek(0x80 + i), saved[i]);
+  }
+}
+
+TEST(recover_after_brownout) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(vcnl.begin());
+  CHECK(vcnl.setProxLEDmA(120));
+  CHECK(vcnl.setThresholds(10, 500));
+
+  uint8_t saved[16];
+  for (uint8_t i = 0; i < 16; i++)
+    saved[i] = sim.peek(0x80 + i);
+
+  sim.powerOnReset();
+  sim.resetCounters();
+  CHECK(vcnl.recover());
+  checkRegisters(sim, saved);
+  CHECK_EQ(sim.reads, 1);
+}
+
+TEST(recover_fails_without_chip) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(vcnl.begin());
+  sim.present = false;
+  CHECK(!vcnl.recover());
+}
+
+TEST(recover_before_begin_fails) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(!vcnl.recover());
+}
+
+TEST(reads_retry_then_report) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(vcnl.begin());
+
+  uint16_t proximity;
+  sim.failReads = 1;
+  CHECK(vcnl.readProximity(&proximity));
+  CHECK_EQ(vcnl.getBusErrors(), 0);
+
+  sim.failReads = 2;
+  CHECK(!vcnl.readProximity(&proximity));
+  CHECK_EQ(vcnl.getBusErrors(), 1);
+  sim.failReads = 2;
+  CHECK_EQ(vcnl.readProximity(), 0xFFFF);
+}
+
+TEST(failed_write_is_reported) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(vcnl.begin());
+
+  vcnl.setRetries(0, 0);
+  sim.failWrites = 1;
+  CHECK(!vcnl.setProxRate(PROX_RATE_7_8_PER_S));
+  CHECK(vcnl.setProxRate(PROX_RATE_7_8_PER_S));
+  CHECK_EQ(sim.peek(VCNL4020_REG_PROX_RATE), PROX_RATE_7_8_PER_S);
+}
+
+TEST(recover_after_failed_apply_restores_the_enables) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(vcnl.begin());
+  vcnl.setRetries(0, 0);
+
+  // The pause goes out, then the LED current write fails
+  vcnl4020_config config;
+  vcnl.getConfig(&config);
+  config.proxLEDmA = 100;
+  sim.passWrites = 1;
+  sim.failWrites = 1;
+  CHECK(!vcnl.applyConfig(&config));
+  CHECK_EQ(sim.peek(VCNL4020_REG_COMMAND) & 0x07, 0x00);
+
+  CHECK(vcnl.recover());
+  CHECK_EQ(sim.peek(VCNL4020_REG_IR_LED_CURRENT), 10);
+  CHECK_EQ(sim.peek(VCNL4020_REG_COMMAND) & 0x07, 0x07);
+}
+
+TEST(value_variants_report_read_errors) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(vcnl.begin());
+  sim.present = false;
+
+  uint32_t milliLux = 123;
+  float lux = 1.0f;
+  uint8_t status = 0x55;
+  bool ready = true;
+  CHECK(!vcnl.readMilliLux(&milliLux));
+  CHECK(!vcnl.readLux(&lux));
+  CHECK(!vcnl.getInterruptStatus(&status));
+  CHECK(!vcnl.readAndClearInterrupts(&status));
+  CHECK(!vcnl.isProxReady(&ready));
+  CHECK(!vcnl.isAmbientReady(&ready));
+  CHECK_EQ(milliLux, 123);
+  CHECK_EQ(status, 0x55);
+  CHECK(ready);
+
+  CHECK_EQ(vcnl.readMilliLux(), 0xFFFFFFFF);
+  CHECK(isnan(vcnl.readLux()));
+  CHECK(!vcnl.isProxReady());
+}
+
+TEST(stale_cache_fails_instead_of_writing_guesses) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(vcnl.begin());
+  vcnl.invalidateRegisters();
+  sim.present = false;
+
+  vcnl4020_config config;
+  CHECK(!vcnl.getConfig(&config));
+  CHECK(!vcnl.setProxRate(PROX_RATE_7_8_PER_S));
+  CHECK(!vcnl.setOnDemand(false, true));
+
+  // Once the chip answers again the cache is refreshed first
+  sim.present = true;
+  sim.resetCounters();
+  CHECK(vcnl.setProxRate(PROX_RATE_7_8_PER_S));
+  CHECK_EQ(sim.reads, 1);
+  CHECK_EQ(sim.peek(VCNL4020_REG_PROX_RATE), PROX_RATE_7_8_PER_S);
+}
+
+TEST(failed_acknowledge_is_reported) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  CHECK(vcnl.begin());
+  vcnl.setRetries(0, 0);
+
+  uint8_t status = 0;
+  sim.poke(VCNL4020_REG_INT_STATUS, VCNL4020_INT_TH_HI);
+  sim.passWrites = 1; // the register address of the status read
+  sim.failWrites = 1;
+  CHECK(!vcnl.readAndClearInterrupts(&status));
+  CHECK_EQ(status, VCNL4020_INT_TH_HI);
+  CHECK_EQ(sim.peek(VCNL4020_REG_INT_STATUS), VCNL4020_INT_TH_HI);
+
+  CHECK(vcnl.readAndClearInterrupts(&status));
+  CHECK_EQ(sim.peek(VCNL4020_REG_INT_STATUS), 0);
+}
+
+TEST(stop_tracking_reports_a_failed_restore) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_Tracker tracker(&vcnl);
+  CHECK(vcnl.begin());
+  vcnl.setRetries(0, 0);
+  uint8_t saved = sim.peek(VCNL4020_REG_INT_CTRL);
+
+  CHECK(tracker.start(100));
+  sim.failWrites = 1;
+  CHECK(!tracker.stop());
+  CHECK(tracker.stop());
+  CHECK_EQ(sim.peek(VCNL4020_REG_INT_CTRL), saved);
+  CHECK(tracker.stop());
+}
+
+TEST(failed_tracking_start_does_not_track) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_Tracker tracker(&vcnl);
+  CHECK(vcnl.begin());
+  vcnl.setRetries(0, 0);
+  uint8_t saved = sim.peek(VCNL4020_REG_INT_CTRL);
+
+  // The baseline read fails, nothing is written
+  sim.failReads = 1;
+  CHECK(!tracker.start(100));
+  sim.poke(VCNL4020_REG_INT_STATUS, VCNL4020_INT_TH_HI);
+  sim.resetCounters();
+  CHECK_EQ(tracker.update(), 0);
+  CHECK_EQ(sim.reads, 0);
+  CHECK_EQ(sim.peek(VCNL4020_REG_INT_CTRL), saved);
+
+  // A retry saves the original interrupt settings, not the failed ones
+  CHECK(tracker.start(100));
+  CHECK(tracker.stop());
+  CHECK_EQ(sim.peek(VCNL4020_REG_INT_CTRL), saved);
+}
+
+TEST(tracking_update_reports_bus_errors) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_Tracker tracker(&vcnl);
+  CHECK(vcnl.begin());
+  vcnl.setRetries(0, 0);
+  CHECK(tracker.start(100));
+
+  // The status read fails, the event stays pending
+  uint8_t events = 0xAA;
+  sim.poke(VCNL4020_REG_INT_STATUS, VCNL4020_INT_TH_HI);
+  sim.failReads = 1;
+  CHECK(!tracker.update(&events));
+  CHECK_EQ(events, 0xAA);
+  CHECK_EQ(sim.peek(VCNL4020_REG_INT_STATUS), VCNL4020_INT_TH_HI);
+
+  // The event is read, but the new window is not written
+  sim.passWrites = 3; // status address, acknowledge, result address
+  sim.failWrites = 1;
+  CHECK(!tracker.update(&events));
+  CHECK_EQ(events, VCNL4020_INT_TH_HI);
+  CHECK_EQ(sim.failWrites, 0);
+  CHECK_EQ(sim.peek(VCNL4020_REG_INT_STATUS), 0);
+
+  CHECK(tracker.update(&events));
+  CHECK_EQ(events, 0);
+  sim.poke(VCNL4020_REG_INT_STATUS, VCNL4020_INT_TH_LOW);
+  CHECK(tracker.update(&events));
+  CHECK_EQ(events, VCNL4020_INT_TH_LOW);
+}
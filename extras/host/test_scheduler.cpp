@@ -0,0 +1,121 @@
+/*!
+ * @file test_scheduler.cpp
+ *
+ * Host tests of the interleaved ALS / proximity scheduler.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Scheduler.h"
+#include "VCNL4020_Sim.h"
+#include "host_test.h"
+
+/*!
+ * @brief  Calls update() every 50 us of simulated time.
+ * @param  scheduler  The scheduler.
+ * @param  micros     How long to run.
+ * @param  prox       Incremented per proximity result.
+ * @param  als        Incremented per ALS result.
+ */
+static void runFor(Adafruit_VCNL4020_Scheduler &scheduler, uint32_t micros,
+                   uint32_t *prox, uint32_t *als) {
+  vcnl4020_sample sample;
+  for (uint32_t t = 0; t < micros; t += 50) {
+    hostAdvance(50);
+    if (scheduler.update(&sample)) {
+      *prox += sample.proxReady;
+      *als += sample.ambientReady;
+    }
+  }
+}
+
+TEST(plan_fastest_proximity_is_on_demand) {
+  vcnl4020_schedule_config config;
+  vcnl4020_schedule_plan plan;
+  Adafruit_VCNL4020_Scheduler::getDefaultConfig(&config);
+  Adafruit_VCNL4020_Scheduler::plan(&config, &plan);
+
+  CHECK_EQ(plan.proxMode, VCNL4020_SCHED_ONDEMAND);
+  CHECK_EQ(plan.alsMode, VCNL4020_SCHED_ONDEMAND);
+  // 8 averaged samples stall proximity 8 ms, within the 10 ms budget
+  CHECK_EQ(plan.averaging, AVG_8_SAMPLES);
+}
+
+TEST(plan_lowers_averaging_to_fit_the_latency) {
+  vcnl4020_schedule_config config = {0, 5000, 200000, 250000,
+                                     AVG_128_SAMPLES};
+  vcnl4020_schedule_plan plan;
+  Adafruit_VCNL4020_Scheduler::plan(&config, &plan);
+  CHECK_EQ(plan.averaging, AVG_4_SAMPLES);
+}
+
+TEST(plan_self_times_both_when_rates_fit) {
+  vcnl4020_schedule_config config = {10000, 40000, 200000, 250000,
+                                     AVG_32_SAMPLES};
+  vcnl4020_schedule_plan plan;
+  Adafruit_VCNL4020_Scheduler::plan(&config, &plan);
+
+  CHECK_EQ(plan.proxMode, VCNL4020_SCHED_SELFTIMED);
+  CHECK_EQ(plan.proxRate, PROX_RATE_125_PER_S);
+  CHECK_EQ(plan.alsMode, VCNL4020_SCHED_SELFTIMED);
+  CHECK_EQ(plan.ambientRate, AMBIENT_RATE_5_SPS);
+}
+
+TEST(plan_triggers_slow_als_on_demand) {
+  vcnl4020_schedule_config config = {10000, 40000, 5000000, 6000000,
+                                     AVG_32_SAMPLES};
+  vcnl4020_schedule_plan plan;
+  Adafruit_VCNL4020_Scheduler::plan(&config, &plan);
+
+  CHECK_EQ(plan.proxMode, VCNL4020_SCHED_SELFTIMED);
+  CHECK_EQ(plan.alsMode, VCNL4020_SCHED_ONDEMAND);
+  CHECK_EQ(plan.alsPeriod, 5000000);
+}
+
+TEST(on_demand_meets_both_budgets) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_Scheduler scheduler(&vcnl);
+  CHECK(vcnl.begin());
+
+  vcnl4020_schedule_config config;
+  scheduler.getDefaultConfig(&config);
+  CHECK(scheduler.begin(&config));
+
+  uint32_t prox = 0, als = 0;
+  runFor(scheduler, 2000000, &prox, &als);
+
+  vcnl4020_schedule_stats stats;
+  scheduler.getStats(&stats);
+  CHECK(prox > 500);    // well above the 250/s self-timed maximum
+  CHECK(als >= 9);      // 5/s
+  CHECK(als <= 11);
+  CHECK_EQ(stats.proxLate, 0);
+  CHECK_EQ(stats.alsLate, 0);
+  CHECK_EQ(stats.timeouts, 0);
+  CHECK_EQ(stats.proxMilliHz, prox * 500);
+}
+
+TEST(self_timed_proximity_with_on_demand_als) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_Scheduler scheduler(&vcnl);
+  CHECK(vcnl.begin());
+
+  vcnl4020_schedule_config config = {10000, 40000, 3000000, 3500000,
+                                     AVG_16_SAMPLES};
+  CHECK(scheduler.begin(&config));
+
+  uint32_t prox = 0, als = 0;
+  runFor(scheduler, 7000000, &prox, &als);
+
+  vcnl4020_schedule_stats stats;
+  scheduler.getStats(&stats);
+  CHECK(prox >= 800); // 125/s, minus the ALS pauses
+  CHECK_EQ(als, 3);   // at 0, 3 and 6 s
+  CHECK_EQ(stats.proxLate, 0);
+  CHECK_EQ(stats.alsLate, 0);
+  // Self-timing is running again after the last pause
+  CHECK_EQ(sim.peek(VCNL4020_REG_COMMAND) & 0x07, 0x03);
+}
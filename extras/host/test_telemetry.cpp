@@ -0,0 +1,191 @@
+/*!
+ * @file test_telemetry.cpp
+ *
+ * Host round trip of telemetry frames through the Python decoder in extras.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020_Telemetry.h"
+#include "host_test.h"
+#include <stdio.h>
+#include <unistd.h>
+
+#define DECODER "python3 ../vcnl4020_telemetry_decode.py"
+#define DECODED "build/telemetry.csv"
+
+/** Print sink that keeps what is written, as a Serial port would send it */
+class CaptureSink : public Print {
+public:
+  uint8_t bytes[2048]; ///< Bytes written
+  size_t used = 0;     ///< Bytes of bytes filled
+
+  /*!
+   * @brief  Appends one byte.
+   * @param  c  The byte.
+   * @return 1, or 0 if full.
+   */
+  size_t write(uint8_t c) {
+    if (used >= sizeof(bytes))
+      return 0;
+    bytes[used++] = c;
+    return 1;
+  }
+  using Print::write;
+};
+
+/*!
+ * @brief  Pipes bytes through the decoder's stdin and reads back its CSV.
+ * @param  data   The capture.
+ * @param  len    Its length.
+ * @param  lines  Where to store the output lines, newlines stripped.
+ * @param  max    Room in lines.
+ * @return The number of lines read.
+ */
+static int decode(const uint8_t *data, size_t len, char lines[][64], int max) {
+  FILE *pipe = popen(DECODER " > " DECODED " 2>&1", "w");
+  if (!pipe)
+    return 0;
+  fwrite(data, 1, len, pipe);
+  pclose(pipe);
+
+  FILE *csv = fopen(DECODED, "r");
+  if (!csv)
+    return 0;
+  int count = 0;
+  while (count < max && fgets(lines[count], 64, csv)) {
+    lines[count][strcspn(lines[count], "\n")] = 0;
+    count++;
+  }
+  fclose(csv);
+  return count;
+}
+
+/*!
+ * @brief  Waits for the decoder to have written a number of lines.
+ * @param  want  The number of lines.
+ * @return True if they were written within two seconds.
+ */
+static bool waitForLines(int want) {
+  for (int tries = 0; tries < 200; tries++) {
+    FILE *csv = fopen(DECODED, "r");
+    int lines = 0;
+    if (csv) {
+      for (int c; (c = fgetc(csv)) != EOF;)
+        lines += c == '\n';
+      fclose(csv);
+    }
+    if (lines >= want)
+      return true;
+    usleep(10000);
+  }
+  return false;
+}
+
+/*!
+ * @brief  The record as a CSV line, as the decoder prints it.
+ * @param  record  The record.
+ * @param  line    Where to store the line.
+ */
+static void csvLine(const vcnl4020_telemetry_record &record, char *line) {
+  snprintf(line, 64, "%u,%u,%lu,%u,%u", record.sensor, record.sequence,
+           (unsigned long)record.timestamp, record.ambient, record.proximity);
+}
+
+TEST(decoder_round_trips_frames) {
+  uint8_t buffer[64];
+  Adafruit_VCNL4020_Telemetry telemetry(buffer, sizeof(buffer));
+  CaptureSink sink;
+
+  // Three sensors interleaved, with steps of one to three varint bytes and
+  // values that go both up and down
+  vcnl4020_telemetry_record sent[60];
+  size_t frameStart[20];
+  uint8_t frameRecords[20];
+  int frames = 0, records = 0;
+  for (int i = 0; i < 60; i++) {
+    vcnl4020_telemetry_record *record = &sent[i];
+    record->sensor = i % 3;
+    record->sequence = 65530 + i / 3;
+    record->timestamp = 4294900000UL + (uint32_t)i * i * i * 13;
+    record->ambient = (i & 1) ? 100 + i * 700 : 40000 - i * 650;
+    record->proximity = (uint16_t)(2300 + ((i % 5) - 2) * 517 * i);
+
+    if (!telemetry.add(*record)) {
+      frameStart[frames] = sink.used;
+      frameRecords[frames++] = telemetry.count();
+      telemetry.send(&sink);
+      CHECK(telemetry.add(*record));
+    }
+  }
+  frameStart[frames] = sink.used;
+  frameRecords[frames++] = telemetry.count();
+  telemetry.send(&sink);
+  CHECK(frames >= 4);
+
+  // Corrupt a record byte of the second frame
+  sink.bytes[frameStart[1] + VCNL4020_TELEMETRY_HEADER + 3] ^= 0x40;
+
+  char lines[80][64];
+  int count = decode(sink.bytes, sink.used, lines, 80);
+  CHECK_EQ(count, 1 + 60 - frameRecords[1] + 1);
+  CHECK(strcmp(lines[0], "sensor,sequence,timestamp_us,ambient,proximity") ==
+        0);
+
+  int line = 1;
+  for (int i = 0; i < 60; i++) {
+    if (i >= frameRecords[0] && i < frameRecords[0] + frameRecords[1])
+      continue;
+    char expected[64];
+    csvLine(sent[i], expected);
+    CHECK(line < count && strcmp(lines[line], expected) == 0);
+    records++;
+    line++;
+  }
+  CHECK_EQ(records, 60 - frameRecords[1]);
+  CHECK(line < count &&
+        strcmp(lines[line], "1 frame(s) failed the CRC check") == 0);
+}
+
+TEST(decoder_skips_a_partial_frame) {
+  uint8_t buffer[64];
+  Adafruit_VCNL4020_Telemetry telemetry(buffer, sizeof(buffer));
+  CaptureSink sink;
+
+  vcnl4020_telemetry_record record = {5000, 1, 200, 300, 2};
+  CHECK(telemetry.add(record));
+  telemetry.send(&sink);
+  record.sequence = 2;
+  CHECK(telemetry.add(record));
+  telemetry.send(&sink);
+
+  // Start mid-frame and stop mid-frame, as a capture joined late and cut
+  char lines[4][64];
+  int count = decode(sink.bytes + 3, sink.used - 3 - 4, lines, 4);
+  CHECK_EQ(count, 1);
+  count = decode(sink.bytes + 3, sink.used - 3, lines, 4);
+  CHECK_EQ(count, 2);
+  CHECK(strcmp(lines[1], "2,2,5000,200,300") == 0);
+}
+
+TEST(decoder_prints_frames_as_they_arrive) {
+  uint8_t buffer[64];
+  Adafruit_VCNL4020_Telemetry telemetry(buffer, sizeof(buffer));
+  CaptureSink sink;
+
+  vcnl4020_telemetry_record record = {5000, 1, 200, 300, 0};
+  CHECK(telemetry.add(record));
+  telemetry.send(&sink);
+
+  // A live capture: the first frame is decoded while the port stays open
+  remove(DECODED);
+  FILE *pipe = popen(DECODER " > " DECODED, "w");
+  CHECK(pipe != NULL);
+  if (!pipe)
+    return;
+  fwrite(sink.bytes, 1, sink.used, pipe);
+  fflush(pipe);
+  CHECK(waitForLines(2));
+  pclose(pipe);
+}
@@ -0,0 +1,152 @@
+/*!
+ * @file test_trace.cpp
+ *
+ * Host tests of bus capture and replay, and of the replay clock.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Adafruit_VCNL4020.h"
+#include "Adafruit_VCNL4020_ProxStream.h"
+#include "Adafruit_VCNL4020_Trace.h"
+#include "VCNL4020_Sim.h"
+#include "host_test.h"
+
+#define TRACE_EVENTS 400 ///< Capacity of the captured trace
+
+/** One captured event with its own copy of the data */
+typedef struct {
+  vcnl4020_bus_event event; ///< The event, data points at bytes
+  uint8_t bytes[16];        ///< The bytes read or written
+} trace_entry;
+
+static trace_entry trace[TRACE_EVENTS]; ///< The captured trace
+static uint16_t traceCount;             ///< Events captured
+static uint16_t traceNext;              ///< Next event to replay
+static uint16_t traceMismatches;        ///< Replayed events that differed
+
+/*!
+ * @brief  Bus tap that appends to the trace.
+ * @param  event  The transaction.
+ */
+static void capture(const vcnl4020_bus_event *event) {
+  if (traceCount >= TRACE_EVENTS)
+    return;
+  trace_entry *entry = &trace[traceCount++];
+  entry->event = *event;
+  if (event->data)
+    memcpy(entry->bytes, event->data, event->len);
+  entry->event.data = entry->bytes;
+}
+
+/*!
+ * @brief  Replay function that answers from the trace.
+ * @param  event     The transaction the driver makes.
+ * @param  readData  Where to store the bytes of a read.
+ * @return The recorded acknowledge.
+ */
+static bool replay(const vcnl4020_bus_event *event, uint8_t *readData) {
+  if (traceNext >= traceCount ||
+      !Adafruit_VCNL4020_Trace::matches(&trace[traceNext].event, event)) {
+    traceMismatches++;
+    return false;
+  }
+  const trace_entry *entry = &trace[traceNext++];
+  if (readData)
+    memcpy(readData, entry->bytes, event->len);
+  return entry->event.ok;
+}
+
+/*!
+ * @brief  Replay clock: the time of the next event in the trace.
+ * @return The timestamp the next transaction was captured at.
+ */
+static uint32_t replayClock() {
+  uint16_t i = (traceNext < traceCount) ? traceNext : traceCount - 1;
+  return trace[i].event.timestamp;
+}
+
+/*!
+ * @brief  Polls the proximity stream.
+ * @param  stream  The proximity stream, started.
+ * @param  step    Microseconds between polls.
+ * @param  polls   How many polls.
+ * @param  values  Where to append the delivered samples.
+ * @param  count   Samples stored so far, updated.
+ */
+static void poll(Adafruit_VCNL4020_ProxStream &stream, uint32_t step,
+                 uint32_t polls, uint16_t *values, uint8_t *count) {
+  while (polls--) {
+    hostAdvance(step);
+    uint16_t proximity;
+    if (stream.next(&proximity) && *count < 100)
+      values[(*count)++] = proximity;
+  }
+}
+
+TEST(replay_reproduces_timing_with_the_clock) {
+  traceCount = traceNext = traceMismatches = 0;
+  uint16_t captured[100], replayed[100];
+  uint8_t capturedCount = 0, replayedCount = 0;
+
+  vcnl4020_stream_stats live;
+  {
+    VCNL4020_Sim sim;
+    Adafruit_VCNL4020 vcnl;
+    Adafruit_VCNL4020_ProxStream stream(&vcnl);
+    vcnl.setBusTap(capture);
+    CHECK(vcnl.begin());
+    CHECK(vcnl.enable(false, true, true));
+    CHECK(stream.start());
+
+    // Stream, stall for 20 ms, stream again
+    sim.setProximity(300);
+    poll(stream, 100, 1000, captured, &capturedCount);
+    hostAdvance(20000);
+    sim.setProximity(900);
+    poll(stream, 100, 1000, captured, &capturedCount);
+    live = stream.getStats();
+  }
+  CHECK(traceCount < TRACE_EVENTS);
+  CHECK(live.dropped >= 4);
+
+  // Replay with a very different poll rate, the clock supplies the timing
+  Adafruit_VCNL4020 vcnl;
+  Adafruit_VCNL4020_ProxStream stream(&vcnl);
+  vcnl.setBusReplay(replay);
+  vcnl.setClock(replayClock);
+  CHECK(vcnl.fastBegin());
+  CHECK(vcnl.enable(false, true, true));
+  CHECK(stream.start());
+  for (uint32_t i = 0; i < 10000 && traceNext < traceCount; i++)
+    poll(stream, 7, 1, replayed, &replayedCount);
+
+  vcnl4020_stream_stats replayStats = stream.getStats();
+  CHECK_EQ(traceMismatches, 0);
+  CHECK_EQ(traceNext, traceCount);
+  CHECK_EQ(replayedCount, capturedCount);
+  CHECK(memcmp(replayed, captured, capturedCount * 2) == 0);
+  CHECK_EQ(replayStats.delivered, live.delivered);
+  CHECK_EQ(replayStats.duplicated, live.duplicated);
+  CHECK_EQ(replayStats.dropped, live.dropped);
+}
+
+TEST(clock_timestamps_interrupt_samples) {
+  VCNL4020_Sim sim;
+  Adafruit_VCNL4020 vcnl;
+  sim.setIntPin(2);
+  CHECK(vcnl.begin());
+  vcnl.setInterruptPin(2);
+  vcnl.setClock(replayClock);
+  traceCount = 1;
+  traceNext = 0;
+  trace[0].event.timestamp = 123456;
+
+  hostAdvance(5000);
+  sim.tick();
+  vcnl4020_timed_sample sample;
+  CHECK(vcnl.fetchInterruptSample(&sample));
+  CHECK_EQ(sample.timestamp, 123456);
+  CHECK_EQ(vcnl.now(), 123456);
+}
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""Decode Adafruit_VCNL4020_Telemetry frames into CSV.
+
+Reads a binary capture from a file, or stdin if no file is given, and prints
+one CSV line per record. Frames with a bad CRC are skipped and counted, and the
+decoder resynchronises on the next 0xA5 0x5A marker, so a capture may start or
+end mid-frame. Records are printed as each frame arrives, so stopping a live
+capture with Ctrl-C loses nothing already received. For example, on Linux:
+
+    stty -F /dev/ttyACM0 raw 115200
+    cat /dev/ttyACM0 | python3 vcnl4020_telemetry_decode.py
+
+See Adafruit_VCNL4020_Telemetry.h for the frame layout.
+"""
+
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+HEADER = 4
+ABSOLUTE = 0x08
+SENSOR_MASK = 0x07
+CHUNK = 4096
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, as Adafruit_VCNL4020::crc16()."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def varint(data, pos):
+    """Read an unsigned LEB128 varint, return (value, next position)."""
+    value = shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def records(payload, count):
+    """Yield (sensor, sequence, timestamp, ambient, proximity) per record."""
+    last = {}
+    pos = 0
+    for _ in range(count):
+        flags = payload[pos]
+        pos += 1
+        sensor = flags & SENSOR_MASK
+        if flags & ABSOLUTE:
+            seq, t_lo, t_hi, ambient, prox = struct.unpack_from("<5H", payload, pos)
+            pos += 10
+            rec = (seq, t_lo | (t_hi << 16), ambient, prox)
+        else:
+            seq, time, ambient, prox = last[sensor]
+            step, pos = varint(payload, pos)
+            seq = (seq + step) & 0xFFFF
+            step, pos = varint(payload, pos)
+            time = (time + step) & 0xFFFFFFFF
+            step, pos = varint(payload, pos)
+            ambient += unzigzag(step)
+            step, pos = varint(payload, pos)
+            prox += unzigzag(step)
+            rec = (seq, time, ambient, prox)
+        last[sensor] = rec
+        yield (sensor,) + rec
+
+
+def frames(buffer):
+    """Yield (payload, count) for each complete frame in buffer with a good CRC,
+    and None for each bad one. The bytes used are removed from buffer, and a
+    frame that is still incomplete is left there for more data."""
+    while True:
+        pos = buffer.find(SYNC)
+        if pos < 0:
+            # Keep a last byte that may be the start of a marker
+            del buffer[: max(len(buffer) - 1, 0)]
+            return
+        del buffer[:pos]
+        if len(buffer) < HEADER:
+            return
+        length, count = buffer[2], buffer[3]
+        end = HEADER + length
+        if end + 2 > len(buffer):
+            return
+        (crc,) = struct.unpack_from("<H", buffer, end)
+        if crc != crc16(buffer[2:end]):
+            del buffer[:1]
+            yield None
+            continue
+        payload = bytes(buffer[HEADER:end])
+        del buffer[: end + 2]
+        yield payload, count
+
+
+def main():
+    source = open(sys.argv[1], "rb") if len(sys.argv) > 1 else sys.stdin.buffer
+    # read1() returns what has arrived instead of waiting for a full chunk
+    read = getattr(source, "read1", source.read)
+    buffer = bytearray()
+    bad = 0
+    print("sensor,sequence,timestamp_us,ambient,proximity")
+    try:
+        while True:
+            chunk = read(CHUNK)
+            if not chunk:
+                break
+            buffer += chunk
+            for frame in frames(buffer):
+                if frame is None:
+                    bad += 1
+                    continue
+                for rec in records(*frame):
+                    print(",".join(str(v) for v in rec))
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+    if bad:
+        print("%d frame(s) failed the CRC check" % bad, file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()